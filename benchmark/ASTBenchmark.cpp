@@ -0,0 +1,256 @@
+#include "Benchmark.hpp"
+
+#include "ast/ASTVisitor.hpp"
+#include "ast/FlatAST.hpp"
+#include "lexer/Lexer.hpp"
+#include "parser/Parser.hpp"
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <optional>
+
+namespace cl = llvm::cl;
+
+namespace { namespace opt {
+
+cl::opt<std::string> input_name{cl::Positional, cl::desc("[bitsy file]")};
+cl::opt<unsigned int> statements{"statements",
+                                 cl::desc("Number of statements in the generated program"),
+                                 cl::init(500000)};
+cl::opt<unsigned int> repetitions{"repetitions", cl::desc("Number of measurements"), cl::init(5)};
+
+}} // namespace ::opt
+
+// Touches every node and all of its data, like a code generator would.
+template <class Nodes>
+class NodeVisitor : public ASTVisitor<NodeVisitor<Nodes>, std::int64_t, Nodes> {
+
+  public:
+    std::size_t nodes = 0;
+    std::int64_t checksum = 0;
+
+    using ASTVisitor<NodeVisitor, std::int64_t, Nodes>::visit;
+
+  private:
+    friend ASTVisitor<NodeVisitor, std::int64_t, Nodes>;
+
+    void visit(typename Nodes::Program program) {
+        ++nodes;
+        visit(program->block);
+    }
+    void visit(typename Nodes::Block block) {
+        ++nodes;
+        for (auto statement : block->statements) {
+            visit(statement);
+        }
+    }
+    void visit(typename Nodes::IfStatement if_statement) {
+        ++nodes;
+        checksum += visit(if_statement->expression);
+        visit(if_statement->then_block);
+        if (if_statement->else_block) {
+            visit(if_statement->else_block);
+        }
+    }
+    void visit(typename Nodes::LoopStatement loop_statement) {
+        ++nodes;
+        visit(loop_statement->block);
+    }
+    void visit(typename Nodes::PrintStatement print_statement) {
+        ++nodes;
+        checksum += visit(print_statement->expression);
+    }
+    void visit(typename Nodes::ReadStatement read_statement) {
+        ++nodes;
+        checksum += visit(read_statement->variable_expression);
+    }
+    void visit(typename Nodes::AssignmentStatement assignment_statement) {
+        ++nodes;
+        checksum += visit(assignment_statement->variable) + visit(assignment_statement->expression);
+    }
+    void visit(typename Nodes::BreakStatement /*break_statement*/) {
+        ++nodes;
+    }
+
+    std::int64_t visit(typename Nodes::NumberExpression number_expression) {
+        ++nodes;
+        return number_expression->value;
+    }
+    std::int64_t visit(typename Nodes::VariableExpression variable_expression) {
+        ++nodes;
+        return variable_expression->symbol;
+    }
+    std::int64_t visit(typename Nodes::BinaryOperationExpression binary_operation_expression) {
+        ++nodes;
+        return binary_operation_expression->operator_symbol + visit(binary_operation_expression->left_expression) +
+               visit(binary_operation_expression->right_expression);
+    }
+};
+
+// The former visitor for comparison. It finds the type of a node by a chain of 'dyn_cast's and reaches the overload
+// with a virtual call.
+class DynamicNodeVisitor {
+
+  public:
+    std::size_t nodes = 0;
+    std::int64_t checksum = 0;
+
+    virtual ~DynamicNodeVisitor() = default;
+
+    void visit(const Statement *statement) {
+        if (const auto *program = llvm::dyn_cast<Program>(statement)) {
+            visit(program);
+        } else if (const auto *block = llvm::dyn_cast<Block>(statement)) {
+            visit(block);
+        } else if (const auto *if_statement = llvm::dyn_cast<IfStatement>(statement)) {
+            visit(if_statement);
+        } else if (const auto *loop_statement = llvm::dyn_cast<LoopStatement>(statement)) {
+            visit(loop_statement);
+        } else if (const auto *print_statement = llvm::dyn_cast<PrintStatement>(statement)) {
+            visit(print_statement);
+        } else if (const auto *read_statement = llvm::dyn_cast<ReadStatement>(statement)) {
+            visit(read_statement);
+        } else if (const auto *assignment_statement = llvm::dyn_cast<AssignmentStatement>(statement)) {
+            visit(assignment_statement);
+        } else if (const auto *break_statement = llvm::dyn_cast<BreakStatement>(statement)) {
+            visit(break_statement);
+        }
+    }
+    std::int64_t visit(const Expression *expression) {
+        if (const auto *number_expression = llvm::dyn_cast<NumberExpression>(expression)) {
+            return visit(number_expression);
+        }
+        if (const auto *variable_expression = llvm::dyn_cast<VariableExpression>(expression)) {
+            return visit(variable_expression);
+        }
+        return visit(llvm::cast<BinaryOperationExpression>(expression));
+    }
+
+  protected:
+    virtual void visit(const Program *program) {
+        ++nodes;
+        visit(program->block);
+    }
+    virtual void visit(const Block *block) {
+        ++nodes;
+        for (const auto *statement : block->statements) {
+            visit(statement);
+        }
+    }
+    virtual void visit(const IfStatement *if_statement) {
+        ++nodes;
+        checksum += visit(if_statement->expression);
+        visit(if_statement->then_block);
+        if (if_statement->else_block) {
+            visit(if_statement->else_block);
+        }
+    }
+    virtual void visit(const LoopStatement *loop_statement) {
+        ++nodes;
+        visit(loop_statement->block);
+    }
+    virtual void visit(const PrintStatement *print_statement) {
+        ++nodes;
+        checksum += visit(print_statement->expression);
+    }
+    virtual void visit(const ReadStatement *read_statement) {
+        ++nodes;
+        checksum += visit(read_statement->variable_expression);
+    }
+    virtual void visit(const AssignmentStatement *assignment_statement) {
+        ++nodes;
+        checksum += visit(assignment_statement->variable) + visit(assignment_statement->expression);
+    }
+    virtual void visit(const BreakStatement * /*break_statement*/) {
+        ++nodes;
+    }
+
+    virtual std::int64_t visit(const NumberExpression *number_expression) {
+        ++nodes;
+        return number_expression->value;
+    }
+    virtual std::int64_t visit(const VariableExpression *variable_expression) {
+        ++nodes;
+        return variable_expression->symbol;
+    }
+    virtual std::int64_t visit(const BinaryOperationExpression *binary_operation_expression) {
+        ++nodes;
+        return binary_operation_expression->operator_symbol + visit(binary_operation_expression->left_expression) +
+               visit(binary_operation_expression->right_expression);
+    }
+};
+
+int main(int argc, char *argv[]) {
+    cl::ParseCommandLineOptions(argc, argv, "Compares visitors and layouts of the AST of a Bitsy program");
+
+    std::string source;
+    if (opt::input_name.empty()) {
+        source = generate_program(opt::statements);
+    } else if (auto file_buffer = llvm::MemoryBuffer::getFile(opt::input_name)) {
+        source = (*file_buffer)->getBuffer().str();
+    } else {
+        std::cerr << "Cannot open the input file." << '\n';
+        return 1;
+    }
+
+    SymbolTable symbols;
+    ASTContext context;
+    Lexer<const char *> lexer{source.data(), source.data() + source.size(), symbols};
+    auto *program = Parser{TokenStream{lexer, decltype(lexer)()}, context}.parse();
+
+    std::optional<FlatAST> flat_program;
+    auto flatten_time = measure(
+        [&]() {
+            flat_program.emplace(program);
+        },
+        opt::repetitions);
+
+    auto dynamic_visitor = std::make_unique<DynamicNodeVisitor>();
+    auto dynamic_time = measure(
+        [&]() {
+            *dynamic_visitor = {};
+            dynamic_visitor->visit(llvm::cast<Statement>(program));
+        },
+        opt::repetitions);
+    NodeVisitor<TreeNodes> tree_visitor;
+    auto tree_time = measure(
+        [&]() {
+            tree_visitor = {};
+            tree_visitor.visit(llvm::cast<Statement>(program));
+        },
+        opt::repetitions);
+    NodeVisitor<FlatAST> flat_visitor;
+    auto flat_time = measure(
+        [&]() {
+            flat_visitor = {};
+            flat_visitor.visit(flat_program->get_root());
+        },
+        opt::repetitions);
+
+    if (tree_visitor.nodes != flat_program->size() || tree_visitor.checksum != flat_visitor.checksum ||
+        dynamic_visitor->checksum != tree_visitor.checksum) {
+        std::cerr << "The visitors disagree." << '\n';
+        return 2;
+    }
+
+    auto nodes = static_cast<double>(flat_program->size());
+    std::printf("%zu nodes\n", flat_program->size());
+    report("flatten", flatten_time, nodes / 1e6, "M nodes/s");
+    report("visit pointer-based AST (dynamic)", dynamic_time, nodes / 1e6, "M nodes/s");
+    report("visit pointer-based AST", tree_time, nodes / 1e6, "M nodes/s");
+    report("visit flat AST", flat_time, nodes / 1e6, "M nodes/s");
+    std::printf("%-40s %10.2f ns/node\n", "pointer-based AST (dynamic)", dynamic_time * 1e9 / nodes);
+    std::printf("%-40s %10.2f ns/node %10.2f bytes/node\n",
+                "pointer-based AST",
+                tree_time * 1e9 / nodes,
+                static_cast<double>(context.get_allocated_bytes()) / nodes);
+    std::printf("%-40s %10.2f ns/node %10.2f bytes/node\n",
+                "flat AST",
+                flat_time * 1e9 / nodes,
+                static_cast<double>(flat_program->get_allocated_bytes()) / nodes);
+    return 0;
+}
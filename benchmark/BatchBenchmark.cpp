@@ -0,0 +1,66 @@
+#include "Benchmark.hpp"
+
+#include "execution/BatchCompiler.hpp"
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Threading.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace cl = llvm::cl;
+
+namespace { namespace opt {
+
+cl::opt<unsigned int> files{"files", cl::desc("Number of generated Bitsy files"), cl::init(64)};
+cl::opt<unsigned int> statements{"statements", cl::desc("Number of statements per file"), cl::init(500)};
+cl::opt<unsigned int> repetitions{"repetitions", cl::desc("Number of measurements per thread count"), cl::init(3)};
+
+}} // namespace ::opt
+
+int main(int argc, char *argv[]) {
+    cl::ParseCommandLineOptions(argc, argv, "Measures how the batch compilation scales with the number of threads");
+
+    auto directory = std::filesystem::temp_directory_path() / "bitsyc-batch-benchmark";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory / "out");
+    for (unsigned int i = 0; i < opt::files; ++i) {
+        std::ofstream{directory / ("program_" + std::to_string(i) + ".bitsy")} << generate_program(opt::statements, i);
+    }
+
+    // Object files leave out the linker, which runs as a process of its own anyway.
+    BatchCompiler compiler{{directory.string()},
+                           (directory / "out").string(),
+                           OutputKind::object,
+                           llvm::OptimizationLevel::O2,
+                           {}};
+    std::vector<unsigned int> thread_counts;
+    auto max_threads = llvm::hardware_concurrency().compute_thread_count();
+    for (unsigned int threads = 1; threads < max_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(max_threads);
+
+    double single_thread_time = 0;
+    for (auto threads : thread_counts) {
+        unsigned int failures = 0;
+        auto time = measure(
+            [&]() {
+                failures = compiler.compile(threads);
+            },
+            opt::repetitions);
+        if (failures > 0) {
+            return 1;
+        }
+        if (threads == 1) {
+            single_thread_time = time;
+        }
+        auto name = std::to_string(threads) + (threads == 1 ? " thread" : " threads");
+        report(name.c_str(), time, opt::files, "files/s");
+        std::printf("%-40s %10.2fx\n", "  speedup", single_thread_time / time);
+    }
+    std::filesystem::remove_all(directory);
+}
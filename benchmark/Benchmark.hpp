@@ -0,0 +1,91 @@
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+
+#include <unistd.h>
+
+// Runs the function the given number of times and returns the fastest run in seconds.
+template <class Function>
+double measure(const Function &function, const unsigned int repetitions = 5) {
+    auto fastest = std::chrono::duration<double>::max();
+    for (unsigned int i = 0; i < repetitions; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        fastest = std::min<std::chrono::duration<double>>(fastest, std::chrono::steady_clock::now() - start);
+    }
+    return fastest.count();
+}
+
+// Generates a terminating Bitsy program with the given number of top-level statements. Every loop breaks out at the end
+// of its first iteration.
+inline std::string generate_program(const unsigned int statements, const unsigned int seed = 42) {
+    std::mt19937 random{seed};
+    auto pick = [&random](unsigned int bound) {
+        return random() % bound;
+    };
+    auto variable = [&pick]() {
+        return "variable_" + std::to_string(pick(1000));
+    };
+    std::string program = "BEGIN { Generated program }\n";
+    for (unsigned int i = 0; i < statements; ++i) {
+        switch (pick(8)) {
+            case 0:
+                program += "  PRINT " + variable() + " % 10\n";
+                break;
+            case 1:
+                program += "  IFZ " + variable() + " % 2\n    " + variable() + " = " + variable() + " - 1\n  ELSE\n    " +
+                           variable() + " = 7\n  END\n";
+                break;
+            case 2:
+                program += "  LOOP\n    " + variable() + " = " + variable() + " * 3\n    BREAK\n  END\n";
+                break;
+            default:
+                program += "  " + variable() + " = (" + variable() + " + " + std::to_string(pick(100000)) + ") * " +
+                           variable() + " - " + std::to_string(pick(10)) + "\n";
+        }
+    }
+    return program + "END\n";
+}
+
+inline void report(const char *name, const double seconds, const double amount, const char *unit) {
+    std::printf("%-40s %10.3f ms %12.2f %s\n", name, seconds * 1000, amount / seconds, unit);
+}
+
+// Redirects everything printed to the standard output into a file while alive, by default a temporary one.
+class CapturedOutput {
+    std::FILE *file;
+    int original_output;
+
+  public:
+    explicit CapturedOutput(std::FILE *file = std::tmpfile())
+      : file(file)
+      , original_output(dup(STDOUT_FILENO)) {
+        std::fflush(stdout);
+        dup2(fileno(file), STDOUT_FILENO);
+    }
+    CapturedOutput(const CapturedOutput &) = delete;
+    CapturedOutput &operator=(const CapturedOutput &) = delete;
+    ~CapturedOutput() {
+        std::fflush(stdout);
+        dup2(original_output, STDOUT_FILENO);
+        close(original_output);
+        std::fclose(file);
+    }
+
+    std::string get_text() {
+        std::fflush(stdout);
+        std::rewind(file);
+        std::string text;
+        for (int character; (character = std::fgetc(file)) != EOF;) {
+            text += static_cast<char>(character);
+        }
+        return text;
+    }
+};
+
+#endif
@@ -0,0 +1,95 @@
+#include "Benchmark.hpp"
+
+#include "codegen/BytecodeGenerator.hpp"
+#include "codegen/ModuleBuilder.hpp"
+#include "execution/Interpreter.hpp"
+#include "execution/ModuleProcessor.hpp"
+#include "lexer/Lexer.hpp"
+#include "parser/Parser.hpp"
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace cl = llvm::cl;
+
+namespace { namespace opt {
+
+cl::opt<std::string> input_name{cl::Positional, cl::desc("[bitsy file]")};
+cl::opt<unsigned int> statements{"statements",
+                                 cl::desc("Number of statements in the generated program"),
+                                 cl::init(20)};
+cl::opt<unsigned int> repetitions{"repetitions", cl::desc("Number of measurements per execution mode"), cl::init(20)};
+
+}} // namespace ::opt
+
+int main(int argc, char *argv[]) {
+    cl::ParseCommandLineOptions(argc, argv, "Compares the startup latency of the JIT compiler and the interpreter");
+
+    std::string source;
+    if (opt::input_name.empty()) {
+        source = generate_program(opt::statements);
+    } else if (auto file_buffer = llvm::MemoryBuffer::getFile(opt::input_name)) {
+        source = (*file_buffer)->getBuffer().str();
+    } else {
+        std::cerr << "Cannot open the input file." << '\n';
+        return 1;
+    }
+
+    SymbolTable symbols;
+    ASTContext context;
+    Lexer<const char *> lexer{source.data(), source.data() + source.size(), symbols};
+    const auto *program = Parser{TokenStream{lexer, decltype(lexer)()}, context}.parse();
+
+    // Everything after parsing, exactly as 'bitsyc' does it.
+    auto run_jit = [&]() {
+        ModuleBuilder builder{program, symbols};
+        ModuleProcessor processor{builder.build(), "a.out"};
+        if (processor.verify()) {
+            std::abort();
+        }
+        processor.optimize();
+        (void)processor.execute();
+    };
+    auto run_interpreter = [&]() {
+        Bytecode bytecode;
+        BytecodeGenerator<>{bytecode, symbols}.visit(llvm::cast<Statement>(program));
+        (void)Interpreter{bytecode}.execute();
+    };
+
+    // The first runs include initializing the native target, which every 'bitsyc' process has to do once.
+    double jit_first_time;
+    double jit_time;
+    std::string jit_output;
+    {
+        CapturedOutput output;
+        jit_first_time = measure(run_jit, 1);
+        jit_output = output.get_text();
+        jit_time = measure(run_jit, opt::repetitions);
+    }
+    double interpreter_first_time;
+    double interpreter_time;
+    std::string interpreter_output;
+    {
+        CapturedOutput output;
+        interpreter_first_time = measure(run_interpreter, 1);
+        interpreter_output = output.get_text();
+        interpreter_time = measure(run_interpreter, opt::repetitions);
+    }
+
+    if (jit_output != interpreter_output) {
+        std::cerr << "The outputs of the JIT compiler and the interpreter differ." << '\n';
+        return 2;
+    }
+
+    std::printf("%zu bytes of source, %zu bytes of output\n", source.size(), jit_output.size());
+    report("JIT (first run)", jit_first_time, 1, "runs/s");
+    report("JIT", jit_time, 1, "runs/s");
+    report("interpreter (first run)", interpreter_first_time, 1, "runs/s");
+    report("interpreter", interpreter_time, 1, "runs/s");
+    std::printf("%-40s %10.1fx\n", "interpreter speedup", jit_time / interpreter_time);
+}
@@ -0,0 +1,103 @@
+#include "Benchmark.hpp"
+
+#include "execution/InputRunner.hpp"
+#include "library/CompiledProgram.hpp"
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Threading.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace cl = llvm::cl;
+
+namespace { namespace opt {
+
+cl::opt<unsigned int> inputs{"inputs", cl::desc("Number of generated input files"), cl::init(2000)};
+cl::opt<unsigned int> numbers{"numbers", cl::desc("Number of numbers per input file"), cl::init(200)};
+cl::opt<unsigned int> max_threads{"max-threads", cl::desc("Largest number of threads (default: one per core)")};
+cl::opt<unsigned int> repetitions{"repetitions", cl::desc("Number of measurements per thread count"), cl::init(3)};
+
+}} // namespace ::opt
+
+int main(int argc, char *argv[]) {
+    cl::ParseCommandLineOptions(argc, argv, "Measures how running a program on many inputs scales with the threads");
+
+    auto directory = std::filesystem::temp_directory_path() / "bitsyc-input-benchmark";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    std::mt19937 random{42};
+    for (unsigned int i = 0; i < opt::inputs; ++i) {
+        std::ofstream input{directory / ("input_" + std::to_string(i))};
+        for (unsigned int j = 0; j < opt::numbers; ++j) {
+            input << random() % 100000 + 1 << '\n';
+        }
+    }
+
+    // Sums up the lengths of the Collatz sequences starting at the numbers in the input.
+    const std::string source = "BEGIN\n"
+                               "  steps = 0\n"
+                               "  LOOP\n"
+                               "    n = 0\n"
+                               "    READ n\n"
+                               "    IFZ n\n"
+                               "      BREAK\n"
+                               "    END\n"
+                               "    LOOP\n"
+                               "      IFZ n - 1\n"
+                               "        BREAK\n"
+                               "      END\n"
+                               "      IFZ n % 2\n"
+                               "        n = n / 2\n"
+                               "      ELSE\n"
+                               "        n = 3 * n + 1\n"
+                               "      END\n"
+                               "      steps = steps + 1\n"
+                               "    END\n"
+                               "  END\n"
+                               "  PRINT steps\n"
+                               "END\n";
+    auto compilation_time = measure(
+        [&]() {
+            CompiledProgram program{source};
+        },
+        opt::repetitions);
+    CompiledProgram program{source};
+    InputRunner runner{program, directory.string()};
+    report("compilation", compilation_time, 1, "programs/s");
+
+    std::vector<unsigned int> thread_counts;
+    auto max_threads = opt::max_threads > 0 ? opt::max_threads.getValue()
+                                            : llvm::hardware_concurrency().compute_thread_count();
+    for (unsigned int threads = 1; threads < max_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(max_threads);
+
+    double single_thread_time = 0;
+    for (auto threads : thread_counts) {
+        unsigned int failures = 0;
+        std::size_t output_size = 0;
+        auto time = measure(
+            [&]() {
+                failures = runner.run(threads, [&output_size](const std::string &, llvm::StringRef output) {
+                    output_size += output.size();
+                });
+            },
+            opt::repetitions);
+        if (failures > 0 || output_size == 0) {
+            return 1;
+        }
+        if (threads == 1) {
+            single_thread_time = time;
+        }
+        auto name = std::to_string(threads) + (threads == 1 ? " thread" : " threads");
+        report(name.c_str(), time, opt::inputs, "inputs/s");
+        std::printf("%-40s %10.2fx\n", "  speedup", single_thread_time / time);
+    }
+    std::filesystem::remove_all(directory);
+}
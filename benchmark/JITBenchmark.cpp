@@ -0,0 +1,138 @@
+#include "Benchmark.hpp"
+
+#include "codegen/ModuleBuilder.hpp"
+#include "execution/ModuleProcessor.hpp"
+#include "lexer/Lexer.hpp"
+#include "parser/Parser.hpp"
+
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <utility>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace cl = llvm::cl;
+
+namespace { namespace opt {
+
+cl::opt<std::string> input_name{cl::Positional, cl::desc("[bitsy file]")};
+cl::opt<unsigned int> statements{"statements",
+                                 cl::desc("Number of statements in the generated program"),
+                                 cl::init(2000)};
+cl::opt<unsigned int> repetitions{"repetitions", cl::desc("Number of measurements per JIT compiler"), cl::init(5)};
+
+}} // namespace ::opt
+
+namespace {
+
+struct Measurement {
+    double seconds;
+    long peak_kilobytes;
+};
+
+// Runs the function in a fresh process, so that the targets have to be initialized again and the peak memory usage
+// belongs to the function alone. The function returns the time that counts.
+template <class Function>
+Measurement measure_in_process(const Function &function) {
+    int time_pipe[2];
+    if (pipe(time_pipe) != 0) {
+        std::abort();
+    }
+    auto child = fork();
+    if (child == 0) {
+        double seconds = function();
+        (void)write(time_pipe[1], &seconds, sizeof(seconds));
+        std::_Exit(0);
+    }
+    close(time_pipe[1]);
+    Measurement measurement{};
+    (void)read(time_pipe[0], &measurement.seconds, sizeof(measurement.seconds));
+    close(time_pipe[0]);
+    int status;
+    rusage usage{};
+    wait4(child, &status, 0, &usage);
+    measurement.peak_kilobytes = usage.ru_maxrss;
+    return measurement;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    cl::ParseCommandLineOptions(argc, argv, "Compares the startup of the ORC and the MCJIT compiler");
+
+    std::string source;
+    if (opt::input_name.empty()) {
+        source = generate_program(opt::statements);
+    } else if (auto file_buffer = llvm::MemoryBuffer::getFile(opt::input_name)) {
+        source = (*file_buffer)->getBuffer().str();
+    } else {
+        std::cerr << "Cannot open the input file." << '\n';
+        return 1;
+    }
+
+    SymbolTable symbols;
+    ASTContext context;
+    Lexer<const char *> lexer{source.data(), source.data() + source.size(), symbols};
+    const auto *program = Parser{TokenStream{lexer, decltype(lexer)()}, context}.parse();
+
+    // The time from the optimized module to a callable 'main', which is all a JIT compiler adds to the startup.
+    auto start_with = [&](auto create_main) {
+        return [&, create_main]() {
+            ModuleBuilder builder{program, symbols};
+            ModuleProcessor processor{builder.build(), "a.out"};
+            processor.optimize();
+            auto start = std::chrono::steady_clock::now();
+            if (!create_main(processor)) {
+                std::abort();
+            }
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        };
+    };
+    auto no_compiler = start_with([](ModuleProcessor &) {
+        return true;
+    });
+    auto mcjit = start_with([](ModuleProcessor &processor) {
+        auto engine = processor.create_engine();
+        return engine->getFunctionAddress("main") != 0;
+    });
+    auto orc = start_with([](ModuleProcessor &processor) {
+        auto jit = processor.create_jit();
+        if (!jit) {
+            return false;
+        }
+        auto main_symbol = jit->lookup("main");
+        if (!main_symbol) {
+            llvm::consumeError(main_symbol.takeError());
+            return false;
+        }
+        return true;
+    });
+
+    std::printf("%zu bytes of source\n%-40s %13s %13s\n", source.size(), "", "startup", "peak memory");
+    const std::pair<const char *, std::function<double()>> compilers[] = {
+        {"no JIT compiler", no_compiler},
+        {"MCJIT", mcjit},
+        {"ORC LLJIT", orc},
+    };
+    for (const auto &[name, function] : compilers) {
+        Measurement best{1e9, 0};
+        for (unsigned int i = 0; i < opt::repetitions; ++i) {
+            auto measurement = measure_in_process(function);
+            best.seconds = std::min(best.seconds, measurement.seconds);
+            best.peak_kilobytes = std::max(best.peak_kilobytes, measurement.peak_kilobytes);
+        }
+        std::printf("%-40s %10.3f ms %10.1f MB\n", name, best.seconds * 1000, best.peak_kilobytes / 1024.0);
+    }
+}
@@ -0,0 +1,163 @@
+#include "Benchmark.hpp"
+
+#include "lexer/Lexer.hpp"
+
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace cl = llvm::cl;
+
+namespace { namespace opt {
+
+cl::opt<std::string> input_name{cl::Positional, cl::desc("[bitsy file]")};
+cl::opt<unsigned int> statements{"statements",
+                                 cl::desc("Number of statements in the generated program"),
+                                 cl::init(500000)};
+cl::opt<unsigned int> repetitions{"repetitions", cl::desc("Number of measurements per lexer"), cl::init(5)};
+
+}} // namespace ::opt
+
+namespace {
+
+// The lexer before the character table and the vectorized scanning, as the reference to compare with. It copied every
+// token into a string, told characters apart with the C library and keywords with a string switch.
+class ReferenceLexer {
+    std::istreambuf_iterator<char> current_character;
+    std::istreambuf_iterator<char> characters_end;
+
+  public:
+    explicit ReferenceLexer(std::istream &stream)
+      : current_character(stream) {}
+
+    std::optional<std::pair<TokenType, std::string>> next() {
+        while (current_character != characters_end) {
+            if (isspace(*current_character) != 0) {
+                ++current_character;
+            } else if (isdigit(*current_character) != 0) {
+                return std::pair{TokenType::number_t, get_while_matching(isdigit)};
+            } else if (is_operator(*current_character)) {
+                return std::pair{TokenType::operator_t, get_while_matching(is_operator)};
+            } else if (*current_character == '=') {
+                return std::pair{TokenType::assignment_t, std::string(1, *current_character++)};
+            } else if (*current_character == '(') {
+                return std::pair{TokenType::left_parenthesis_t, std::string(1, *current_character++)};
+            } else if (*current_character == ')') {
+                return std::pair{TokenType::right_parenthesis_t, std::string(1, *current_character++)};
+            } else if (is_identifier(*current_character)) {
+                auto token = get_while_matching(is_identifier);
+                auto token_type = llvm::StringSwitch<TokenType>(token)
+                                      .Case("BEGIN", TokenType::begin_t)
+                                      .Case("END", TokenType::end_t)
+                                      .Case("LOOP", TokenType::loop_t)
+                                      .Case("BREAK", TokenType::break_t)
+                                      .Case("IFN", TokenType::ifn_t)
+                                      .Case("IFP", TokenType::ifp_t)
+                                      .Case("IFZ", TokenType::ifz_t)
+                                      .Case("ELSE", TokenType::else_t)
+                                      .Case("PRINT", TokenType::print_t)
+                                      .Case("READ", TokenType::read_t)
+                                      .Default(TokenType::variable_t);
+                return std::pair{token_type, std::move(token)};
+            } else if (*current_character == '{') {
+                current_character = std::next(std::find(current_character, characters_end, '}'));
+            } else {
+                throw std::logic_error("Cannot handle the current character.");
+            }
+        }
+        return std::nullopt;
+    }
+
+  private:
+    template <class TokenMatcher>
+    std::string get_while_matching(const TokenMatcher &matcher) {
+        std::string value;
+        do {
+            value += *current_character++;
+        } while (current_character != characters_end && matcher(*current_character));
+        return value;
+    }
+
+    static bool is_operator(const char c) {
+        return c == '+' || c == '-' || c == '*' || c == '/' || c == '%';
+    }
+
+    static bool is_identifier(const char c) {
+        return (isalnum(c) != 0) || c == '_';
+    }
+};
+
+} // namespace
+
+template <class InputIterator>
+static std::size_t count_tokens(Lexer<InputIterator> lexer) {
+    std::size_t tokens = 0;
+    for (; lexer != Lexer<InputIterator>(); ++lexer) {
+        ++tokens;
+    }
+    return tokens;
+}
+
+int main(int argc, char *argv[]) {
+    cl::ParseCommandLineOptions(argc, argv, "Measures the throughput of the Bitsy lexer");
+
+    std::string source;
+    if (opt::input_name.empty()) {
+        source = generate_program(opt::statements);
+    } else if (auto file_buffer = llvm::MemoryBuffer::getFile(opt::input_name)) {
+        source = (*file_buffer)->getBuffer().str();
+    } else {
+        std::cerr << "Cannot open the input file." << '\n';
+        return 1;
+    }
+    const auto megabytes = static_cast<double>(source.size()) / (1024 * 1024);
+
+    std::size_t reference_tokens = 0;
+    auto reference_time = measure(
+        [&]() {
+            std::istringstream stream{source};
+            ReferenceLexer lexer{stream};
+            for (reference_tokens = 0; lexer.next(); ++reference_tokens) {
+            }
+        },
+        opt::repetitions);
+
+    std::size_t stream_tokens = 0;
+    auto stream_time = measure(
+        [&]() {
+            std::istringstream stream{source};
+            SymbolTable symbols;
+            stream_tokens = count_tokens(Lexer<std::istreambuf_iterator<char>>{stream, {}, symbols});
+        },
+        opt::repetitions);
+
+    std::size_t buffer_tokens = 0;
+    auto buffer_time = measure(
+        [&]() {
+            SymbolTable symbols;
+            buffer_tokens = count_tokens(Lexer<const char *>{source.data(), source.data() + source.size(), symbols});
+        },
+        opt::repetitions);
+
+    if (reference_tokens != buffer_tokens || stream_tokens != buffer_tokens) {
+        std::cerr << "Lexers disagree on the number of tokens." << '\n';
+        return 2;
+    }
+    std::printf("%.2f MB, %zu tokens\n", megabytes, buffer_tokens);
+    report("previous lexer (streambuf iterator)", reference_time, megabytes, "MB/s");
+    report("lexer on streambuf iterator (scalar)", stream_time, megabytes, "MB/s");
+    report("lexer on memory buffer (vectorized)", buffer_time, megabytes, "MB/s");
+    std::printf("%-40s %10.2fx\n", "speedup over the previous lexer", reference_time / buffer_time);
+    return 0;
+}
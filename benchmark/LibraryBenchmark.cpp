@@ -0,0 +1,66 @@
+#include "Benchmark.hpp"
+
+#include "library/CompiledProgram.hpp"
+
+#include "llvm/Support/CommandLine.h"
+
+#include <iostream>
+#include <string>
+
+namespace cl = llvm::cl;
+
+namespace { namespace opt {
+
+cl::opt<unsigned int> invocations{"invocations", cl::desc("Number of runs of the compiled program"), cl::init(1000000)};
+cl::opt<unsigned int> compilations{"compilations", cl::desc("Number of compilations"), cl::init(20)};
+cl::opt<unsigned int> repetitions{"repetitions", cl::desc("Number of measurements per variant"), cl::init(3)};
+
+}} // namespace ::opt
+
+int main(int argc, char *argv[]) {
+    cl::ParseCommandLineOptions(argc, argv, "Measures the cost of running an embedded program repeatedly");
+
+    // Sums up its input, so that each run both reads and writes.
+    const std::string source = "BEGIN\n"
+                               "  sum = 0\n"
+                               "  LOOP\n"
+                               "    n = 0\n"
+                               "    READ n\n"
+                               "    IFZ n\n"
+                               "      BREAK\n"
+                               "    END\n"
+                               "    sum = sum + n\n"
+                               "  END\n"
+                               "  PRINT sum\n"
+                               "END\n";
+    const std::string input = "1 2 3 4 5 6 7 8 9 10";
+
+    auto compile_time = measure(
+        [&]() {
+            for (unsigned int i = 0; i < opt::compilations; ++i) {
+                CompiledProgram program{source};
+            }
+        },
+        opt::repetitions);
+
+    CompiledProgram program{source};
+    std::string output;
+    auto run_time = measure(
+        [&]() {
+            for (unsigned int i = 0; i < opt::invocations; ++i) {
+                output.clear();
+                program.run(input, output);
+            }
+        },
+        opt::repetitions);
+    if (output != "55\n") {
+        std::cerr << "The program printed '" << output << "' instead of 55." << '\n';
+        return 1;
+    }
+
+    std::printf("%-40s %13s %12s\n", "", "total", "throughput");
+    report("compilation", compile_time, opt::compilations, "programs/s");
+    report("run with string I/O", run_time, opt::invocations, "runs/s");
+    std::printf("%-40s %10.3f us\n", "compilation per run", compile_time / opt::compilations * 1e6);
+    std::printf("%-40s %10.3f us\n", "run", run_time / opt::invocations * 1e6);
+}
@@ -0,0 +1,102 @@
+#include "Benchmark.hpp"
+
+#include "codegen/ModuleBuilder.hpp"
+#include "execution/ModuleProcessor.hpp"
+#include "lexer/Lexer.hpp"
+#include "parser/Parser.hpp"
+
+#include "llvm/Passes/OptimizationLevel.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cl = llvm::cl;
+
+namespace { namespace opt {
+
+cl::list<std::string> input_names{cl::Positional, cl::desc("[bitsy files]")};
+cl::opt<unsigned int> repetitions{"repetitions",
+                                  cl::desc("Number of measurements per optimization level"),
+                                  cl::init(3)};
+
+}} // namespace ::opt
+
+int main(int argc, char *argv[]) {
+    cl::ParseCommandLineOptions(argc, argv, "Compares the optimization levels on loop-heavy programs");
+
+    std::vector<std::string> input_names{opt::input_names.begin(), opt::input_names.end()};
+    if (input_names.empty()) {
+        for (const auto &entry : std::filesystem::directory_iterator{BENCHMARK_PROGRAMS_PATH}) {
+            input_names.push_back(entry.path().string());
+        }
+        std::sort(input_names.begin(), input_names.end());
+    }
+
+    const std::pair<const char *, llvm::OptimizationLevel> levels[] = {
+        {"-O0", llvm::OptimizationLevel::O0},
+        {"-O1", llvm::OptimizationLevel::O1},
+        {"-O2", llvm::OptimizationLevel::O2},
+        {"-O3", llvm::OptimizationLevel::O3},
+        {"-Os", llvm::OptimizationLevel::Os},
+    };
+
+    for (const auto &input_name : input_names) {
+        auto file_buffer = llvm::MemoryBuffer::getFile(input_name);
+        if (!file_buffer) {
+            std::cerr << "Cannot open the input file " << input_name << "." << '\n';
+            return 1;
+        }
+        SymbolTable symbols;
+        ASTContext context;
+        Lexer<const char *> lexer{(*file_buffer)->getBufferStart(), (*file_buffer)->getBufferEnd(), symbols};
+        const auto *program = Parser{TokenStream{lexer, decltype(lexer)()}, context}.parse();
+
+        std::printf("%s\n%-40s %13s %13s %11s\n", input_name.c_str(), "", "compilation", "execution", "speedup");
+        std::string expected_output;
+        double baseline_time = 0;
+        for (const auto &[name, level] : levels) {
+            ModuleBuilder builder{program, symbols};
+            ModuleProcessor processor{builder.build(), ""};
+            if (processor.verify()) {
+                return 2;
+            }
+            std::unique_ptr<llvm::ExecutionEngine> engine;
+            int (*main_function)() = nullptr;
+            auto compilation_time = measure(
+                [&]() {
+                    processor.optimize(level);
+                    engine = processor.create_engine();
+                    main_function = reinterpret_cast<int (*)()>(engine->getFunctionAddress("main"));
+                },
+                1);
+
+            double execution_time;
+            std::string output;
+            {
+                CapturedOutput captured_output;
+                execution_time = measure(main_function, opt::repetitions);
+                output = captured_output.get_text();
+            }
+            if (expected_output.empty()) {
+                expected_output = output;
+                baseline_time = execution_time;
+            } else if (output != expected_output) {
+                std::cerr << "The output at " << name << " differs from the one at -O0." << '\n';
+                return 3;
+            }
+            std::printf("%-40s %10.1f ms %10.1f ms %10.2fx\n",
+                        name,
+                        compilation_time * 1000,
+                        execution_time * 1000,
+                        baseline_time / execution_time);
+        }
+    }
+}
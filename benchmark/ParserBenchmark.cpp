@@ -0,0 +1,109 @@
+#include "Benchmark.hpp"
+
+#include "ast/FlatAST.hpp"
+#include "lexer/Lexer.hpp"
+#include "parser/ParallelParser.hpp"
+#include "parser/Parser.hpp"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <string>
+
+namespace cl = llvm::cl;
+
+namespace { namespace opt {
+
+cl::opt<std::string> input_name{cl::Positional, cl::desc("[bitsy file]")};
+cl::opt<unsigned int> statements{"statements",
+                                 cl::desc("Number of statements in the generated program"),
+                                 cl::init(500000)};
+cl::opt<unsigned int> repetitions{"repetitions", cl::desc("Number of measurements"), cl::init(5)};
+cl::list<unsigned int> threads{"threads",
+                               cl::desc("Thread counts to measure the parallel parser with (default: 1,2,4,8)"),
+                               cl::CommaSeparated};
+
+}} // namespace ::opt
+
+static std::size_t heap_allocations = 0;
+
+void *operator new(std::size_t size) {
+    ++heap_allocations;
+    if (auto *memory = std::malloc(size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t /*size*/) noexcept {
+    std::free(memory);
+}
+
+int main(int argc, char *argv[]) {
+    cl::ParseCommandLineOptions(argc, argv, "Measures the time and allocations needed to parse a Bitsy program");
+
+    std::string source;
+    if (opt::input_name.empty()) {
+        source = generate_program(opt::statements);
+    } else if (auto file_buffer = llvm::MemoryBuffer::getFile(opt::input_name)) {
+        source = (*file_buffer)->getBuffer().str();
+    } else {
+        std::cerr << "Cannot open the input file." << '\n';
+        return 1;
+    }
+
+    std::size_t allocations = 0;
+    std::size_t arena_bytes = 0;
+    auto time = measure(
+        [&]() {
+            auto allocations_before = heap_allocations;
+            SymbolTable symbols;
+            ASTContext context;
+            Lexer<const char *> lexer{source.data(), source.data() + source.size(), symbols};
+            Parser{TokenStream{lexer, decltype(lexer)()}, context}.parse();
+            allocations = heap_allocations - allocations_before;
+            arena_bytes = context.get_allocated_bytes();
+        },
+        opt::repetitions);
+
+    std::printf("%.2f MB of source\n", static_cast<double>(source.size()) / (1024 * 1024));
+    report("lex and parse", time, static_cast<double>(source.size()) / (1024 * 1024), "MB/s");
+    std::printf("%zu heap allocations, %zu bytes of AST nodes\n", allocations, arena_bytes);
+
+    SymbolTable symbols;
+    ASTContext context;
+    Lexer<const char *> lexer{source.data(), source.data() + source.size(), symbols};
+    FlatAST sequential_program{Parser{TokenStream{lexer, decltype(lexer)()}, context}.parse()};
+
+    llvm::SmallVector<unsigned int, 4> thread_counts{opt::threads.begin(), opt::threads.end()};
+    if (thread_counts.empty()) {
+        thread_counts = {1, 2, 4, 8};
+    }
+    for (auto thread_count : thread_counts) {
+        std::optional<FlatAST> parallel_program;
+        auto parallel_time = measure(
+            [&]() {
+                SymbolTable symbols;
+                ASTContext context;
+                ParallelParser parser{source.data(), source.data() + source.size(), symbols, context, thread_count};
+                parallel_program.emplace(parser.parse());
+            },
+            opt::repetitions);
+        if (*parallel_program != sequential_program) {
+            std::cerr << "The parallel parser produced a different program." << '\n';
+            return 2;
+        }
+        auto name = "lex and parse on " + std::to_string(thread_count) + " thread(s)";
+        report(name.c_str(), parallel_time, static_cast<double>(source.size()) / (1024 * 1024), "MB/s");
+    }
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include "Benchmark.hpp"
+
+#include "runtime/Runtime.hpp"
+
+#include "llvm/Support/CommandLine.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace cl = llvm::cl;
+
+namespace { namespace opt {
+
+cl::opt<unsigned int> numbers{"numbers", cl::desc("Number of printed numbers"), cl::init(5000000)};
+cl::opt<unsigned int> repetitions{"repetitions", cl::desc("Number of measurements per print function"), cl::init(5)};
+
+}} // namespace ::opt
+
+int main(int argc, char *argv[]) {
+    cl::ParseCommandLineOptions(argc, argv, "Measures the throughput of the PRINT runtime");
+
+    // Numbers of all lengths and both signs.
+    std::mt19937 random{42};
+    std::vector<std::int32_t> values(opt::numbers);
+    for (auto &value : values) {
+        value = static_cast<std::int32_t>(random()) >> (random() % 32);
+    }
+
+    // 'PRINT' used to be lowered to exactly this call.
+    auto print_with_printf = [&values]() {
+        for (auto value : values) {
+            std::printf("%i\n", value);
+        }
+        std::fflush(stdout);
+    };
+    auto print_with_runtime = [&values]() {
+        for (auto value : values) {
+            bitsy_print_i32(value);
+        }
+        bitsy_flush();
+    };
+
+    {
+        CapturedOutput printf_output;
+        print_with_printf();
+        auto expected = printf_output.get_text();
+        CapturedOutput runtime_output;
+        print_with_runtime();
+        if (runtime_output.get_text() != expected) {
+            std::cerr << "The outputs of 'printf' and the runtime differ." << '\n';
+            return 1;
+        }
+    }
+
+    double printf_time;
+    double runtime_time;
+    {
+        CapturedOutput discarded_output{std::fopen("/dev/null", "w")};
+        printf_time = measure(print_with_printf, opt::repetitions);
+        runtime_time = measure(print_with_runtime, opt::repetitions);
+    }
+
+    report("printf", printf_time, opt::numbers, "lines/s");
+    report("bitsy_print_i32", runtime_time, opt::numbers, "lines/s");
+    std::printf("%-40s %10.1fx\n", "runtime speedup", printf_time / runtime_time);
+}
@@ -0,0 +1,78 @@
+#include "Benchmark.hpp"
+
+#include "runtime/Runtime.hpp"
+
+#include "llvm/Support/CommandLine.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include <unistd.h>
+
+namespace cl = llvm::cl;
+
+namespace { namespace opt {
+
+cl::opt<unsigned int> numbers{"numbers", cl::desc("Number of read numbers"), cl::init(100000000)};
+cl::opt<unsigned int> repetitions{"repetitions", cl::desc("Number of measurements per read function"), cl::init(3)};
+
+}} // namespace ::opt
+
+int main(int argc, char *argv[]) {
+    cl::ParseCommandLineOptions(argc, argv, "Measures the throughput of the READ runtime");
+
+    // The standard input is replaced by a temporary file with numbers of all lengths and both signs.
+    auto *input = std::tmpfile();
+    std::mt19937 random{42};
+    std::string chunk;
+    for (unsigned int i = 0; i < opt::numbers; ++i) {
+        chunk += std::to_string(static_cast<std::int32_t>(random()) >> (random() % 32));
+        chunk += i % 10 == 9 ? '\n' : ' ';
+        if (chunk.size() > 1024 * 1024) {
+            std::fwrite(chunk.data(), 1, chunk.size(), input);
+            chunk.clear();
+        }
+    }
+    std::fwrite(chunk.data(), 1, chunk.size(), input);
+    std::fflush(input);
+    auto input_size = static_cast<double>(std::ftell(input));
+    dup2(fileno(input), STDIN_FILENO);
+
+    // Both sum up all numbers, so their results can be compared.
+    std::uint32_t scanf_sum;
+    std::uint32_t runtime_sum;
+    auto read_with_scanf = [&scanf_sum]() {
+        std::rewind(stdin);
+        scanf_sum = 0;
+        int value = 0;
+        for (unsigned int i = 0; i < opt::numbers; ++i) {
+            (void)std::scanf("%i", &value);
+            scanf_sum += static_cast<std::uint32_t>(value);
+        }
+    };
+    auto read_with_runtime = [&runtime_sum]() {
+        lseek(STDIN_FILENO, 0, SEEK_SET);
+        runtime_sum = 0;
+        std::int32_t value = 0;
+        for (unsigned int i = 0; i < opt::numbers; ++i) {
+            value = bitsy_read_i32(value);
+            runtime_sum += static_cast<std::uint32_t>(value);
+        }
+    };
+
+    auto scanf_time = measure(read_with_scanf, opt::repetitions);
+    auto runtime_time = measure(read_with_runtime, opt::repetitions);
+    if (scanf_sum != runtime_sum) {
+        std::cerr << "The numbers read by 'scanf' and the runtime differ." << '\n';
+        return 1;
+    }
+
+    std::printf("%.0f bytes of input\n", input_size);
+    report("scanf", scanf_time, opt::numbers, "numbers/s");
+    report("bitsy_read_i32", runtime_time, opt::numbers, "numbers/s");
+    report("bitsy_read_i32 (bytes)", runtime_time, input_size / (1024 * 1024), "MB/s");
+    std::printf("%-40s %10.1fx\n", "runtime speedup", scanf_time / runtime_time);
+}
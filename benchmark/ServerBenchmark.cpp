@@ -0,0 +1,153 @@
+#include "Benchmark.hpp"
+
+#include "helper/BitsycPath.hpp"
+#include "server/Protocol.hpp"
+
+#include "llvm/Support/CommandLine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace cl = llvm::cl;
+
+namespace { namespace opt {
+
+cl::opt<std::string> input_name{cl::Positional, cl::desc("[bitsy file]")};
+cl::opt<unsigned int> statements{"statements",
+                                 cl::desc("Number of statements in the generated program"),
+                                 cl::init(20)};
+cl::opt<unsigned int> requests{"requests", cl::desc("Number of requests per client"), cl::init(100)};
+cl::list<unsigned int> clients{"clients",
+                               cl::desc("Numbers of concurrent clients (default: 1, 4 and 16)"),
+                               cl::CommaSeparated};
+
+}} // namespace ::opt
+
+namespace {
+
+pid_t spawn(const std::vector<std::string> &arguments) {
+    std::vector<char *> argv;
+    for (const auto &argument : arguments) {
+        argv.push_back(const_cast<char *>(argument.c_str()));
+    }
+    argv.push_back(nullptr);
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    pid_t process;
+    if (posix_spawn(&process, argv.front(), &actions, nullptr, argv.data(), environ) != 0) {
+        std::cerr << "Cannot run " << arguments.front() << "." << '\n';
+        std::exit(1);
+    }
+    posix_spawn_file_actions_destroy(&actions);
+    return process;
+}
+
+// Runs the command once per request in every client and returns the latencies of all requests.
+std::vector<double> measure_latencies(const std::vector<std::string> &command, const unsigned int clients) {
+    std::vector<std::vector<double>> latencies(clients);
+    std::vector<std::thread> threads;
+    for (auto &client_latencies : latencies) {
+        threads.emplace_back([&command, &client_latencies]() {
+            for (unsigned int i = 0; i < opt::requests; ++i) {
+                auto start = std::chrono::steady_clock::now();
+                int status;
+                waitpid(spawn(command), &status, 0);
+                client_latencies.push_back(
+                    std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+                if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                    std::cerr << command.front() << " failed." << '\n';
+                    std::exit(1);
+                }
+            }
+        });
+    }
+    std::vector<double> all_latencies;
+    for (std::size_t i = 0; i < threads.size(); ++i) {
+        threads[i].join();
+        all_latencies.insert(all_latencies.end(), latencies[i].begin(), latencies[i].end());
+    }
+    std::sort(all_latencies.begin(), all_latencies.end());
+    return all_latencies;
+}
+
+double get_percentile(const std::vector<double> &sorted_latencies, const double percentile) {
+    auto rank = static_cast<std::size_t>(std::ceil(percentile * static_cast<double>(sorted_latencies.size())));
+    return sorted_latencies[std::max<std::size_t>(rank, 1) - 1];
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    cl::ParseCommandLineOptions(argc, argv, "Compares the request latency of bitsyc and of the compile server");
+
+    auto directory = std::filesystem::temp_directory_path() / "bitsyc-server-benchmark";
+    std::filesystem::create_directories(directory);
+    auto input_name = opt::input_name.getValue();
+    if (input_name.empty()) {
+        input_name = (directory / "program.bitsy").string();
+        std::ofstream{input_name} << generate_program(opt::statements);
+    }
+    std::vector<unsigned int> client_counts{opt::clients.begin(), opt::clients.end()};
+    if (client_counts.empty()) {
+        client_counts = {1, 4, 16};
+    }
+
+    auto socket_path = (directory / "bitsyc.sock").string();
+    setenv("BITSYC_SOCKET", socket_path.c_str(), 1);
+    auto server = spawn({BITSYC_PATH, "--serve"});
+    while (true) {
+        if (auto connection = connect_to_server(socket_path); connection >= 0) {
+            close(connection);
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    }
+
+    const std::pair<const char *, std::vector<std::string>> commands[] = {
+        {"bitsyc", {BITSYC_PATH, input_name}},
+        {"bitsyc-client", {BITSYC_CLIENT_PATH, input_name}},
+        {"bitsyc --interpret", {BITSYC_PATH, "--interpret", input_name}},
+        {"bitsyc-client --interpret", {BITSYC_CLIENT_PATH, "--interpret", input_name}},
+    };
+    std::printf("%s, %u requests per client\n%-40s %13s %13s %13s\n",
+                input_name.c_str(),
+                opt::requests.getValue(),
+                "",
+                "p50",
+                "p99",
+                "requests/s");
+    for (auto clients : client_counts) {
+        for (const auto &[name, command] : commands) {
+            auto start = std::chrono::steady_clock::now();
+            auto latencies = measure_latencies(command, clients);
+            auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            auto label = std::string{name} + ", " + std::to_string(clients) + " clients";
+            std::printf("%-40s %10.2f ms %10.2f ms %13.0f\n",
+                        label.c_str(),
+                        get_percentile(latencies, 0.5) * 1000,
+                        get_percentile(latencies, 0.99) * 1000,
+                        static_cast<double>(latencies.size()) / seconds);
+        }
+    }
+
+    kill(server, SIGTERM);
+    waitpid(server, nullptr, 0);
+}
@@ -0,0 +1,58 @@
+#ifndef ASTCONTEXT_HPP
+#define ASTCONTEXT_HPP
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/Support/Allocator.h"
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Owns all nodes of an AST. Nodes are bump-allocated next to each other and are never destroyed one by one, which is
+// why they must be trivially destructible. The whole tree is freed at once together with the context.
+class ASTContext {
+    llvm::BumpPtrAllocator allocator;
+    std::vector<std::unique_ptr<ASTContext>> nested_contexts;
+    std::size_t node_count = 0;
+
+  public:
+    template <class Node, class... Arguments>
+    Node *create(Arguments &&...arguments) {
+        static_assert(std::is_trivially_destructible_v<Node>, "AST nodes are never destroyed.");
+        ++node_count;
+        return new (allocator.Allocate<Node>()) Node(std::forward<Arguments>(arguments)...);
+    }
+
+    template <class T>
+    llvm::ArrayRef<T> copy(llvm::ArrayRef<T> elements) {
+        static_assert(std::is_trivially_destructible_v<T>, "AST nodes are never destroyed.");
+        auto *copied_elements = allocator.Allocate<T>(elements.size());
+        std::uninitialized_copy(elements.begin(), elements.end(), copied_elements);
+        return {copied_elements, elements.size()};
+    }
+
+    // A context whose nodes live as long as the ones of this context. Different contexts can be used concurrently.
+    ASTContext &create_nested_context() {
+        return *nested_contexts.emplace_back(std::make_unique<ASTContext>());
+    }
+
+    [[nodiscard]] std::size_t get_node_count() const {
+        auto count = node_count;
+        for (const auto &nested_context : nested_contexts) {
+            count += nested_context->get_node_count();
+        }
+        return count;
+    }
+
+    [[nodiscard]] std::size_t get_allocated_bytes() const {
+        auto bytes = allocator.getBytesAllocated();
+        for (const auto &nested_context : nested_contexts) {
+            bytes += nested_context->get_allocated_bytes();
+        }
+        return bytes;
+    }
+};
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef ASTOPTIMIZER_HPP
+#define ASTOPTIMIZER_HPP
+
+#include "ast/ASTContext.hpp"
+#include "ast/Statement.hpp"
+
+// Simplifies a parsed program before code is generated for it. Constant operations are folded with the wrap-around
+// semantics of 32-bit integers, conditions known at compile time are replaced by the branch they select, statements
+// behind a BREAK are dropped and so are assignments to variables that are never read.
+//
+// The program is changed in place. Nodes replacing existing ones are allocated in the given context. Like the parser,
+// the optimizer keeps its work on explicit stacks, so the nesting depth of programs is only limited by memory.
+class ASTOptimizer {
+    ASTContext &context;
+
+  public:
+    explicit ASTOptimizer(ASTContext &context)
+      : context(context) {}
+
+    void optimize(Program *program);
+
+  private:
+    void simplify(Block *block);
+    void remove_dead_assignments(Block *block);
+    Expression *fold(Expression *expression);
+};
+
+#endif
@@ -3,24 +3,31 @@
 
 #include "ast/ASTVisitor.hpp"
 
-class ASTPrinter : public ASTVisitor<void> {
+template <class Nodes = TreeNodes>
+class ASTPrinter : public ASTVisitor<ASTPrinter<Nodes>, void, Nodes> {
+    const SymbolTable &symbols;
 
   public:
-    using ASTVisitor<void>::visit;
+    explicit ASTPrinter(const SymbolTable &symbols)
+      : symbols(symbols) {}
+
+    using ASTVisitor<ASTPrinter, void, Nodes>::visit;
 
   private:
-    void visit(const Program *program) override;
-    void visit(const Block *block) override;
-    void visit(const IfStatement *if_statement) override;
-    void visit(const LoopStatement *loop_statement) override;
-    void visit(const PrintStatement *print_statement) override;
-    void visit(const ReadStatement *read_statement) override;
-    void visit(const AssignmentStatement *assignment_statement) override;
-    void visit(const BreakStatement *break_statement) override;
-
-    void visit(const NumberExpression *number_expression) override;
-    void visit(const VariableExpression *variable_expression) override;
-    void visit(const BinaryOperationExpression *binary_operation_expression) override;
+    friend ASTVisitor<ASTPrinter, void, Nodes>;
+
+    void visit(typename Nodes::Program program);
+    void visit(typename Nodes::Block block);
+    void visit(typename Nodes::IfStatement if_statement);
+    void visit(typename Nodes::LoopStatement loop_statement);
+    void visit(typename Nodes::PrintStatement print_statement);
+    void visit(typename Nodes::ReadStatement read_statement);
+    void visit(typename Nodes::AssignmentStatement assignment_statement);
+    void visit(typename Nodes::BreakStatement break_statement);
+
+    void visit(typename Nodes::NumberExpression number_expression);
+    void visit(typename Nodes::VariableExpression variable_expression);
+    void visit(typename Nodes::BinaryOperationExpression binary_operation_expression);
 };
 
 #endif
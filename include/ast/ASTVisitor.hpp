@@ -4,70 +4,128 @@
 #include "ast/Expression.hpp"
 #include "ast/Statement.hpp"
 
-#include "llvm/Support/Casting.h"
+#include "llvm/ADT/SmallVector.h"
 
 #include <stdexcept>
+#include <type_traits>
+#include <variant>
 
-template <class ExpressionReturnType>
-class ASTVisitor {
+// The pointer-based nodes produced by the 'Parser'. Visitors are parameterized over a node family like this one or
+// 'FlatAST', which provides handles with the same members.
+struct TreeNodes {
+    using Statement = const ::Statement *;
+    using Program = const ::Program *;
+    using Block = const ::Block *;
+    using IfStatement = const ::IfStatement *;
+    using LoopStatement = const ::LoopStatement *;
+    using PrintStatement = const ::PrintStatement *;
+    using ReadStatement = const ::ReadStatement *;
+    using AssignmentStatement = const ::AssignmentStatement *;
+    using BreakStatement = const ::BreakStatement *;
 
-  public:
-    void visit(const Statement *statement);
+    using Expression = const ::Expression *;
+    using NumberExpression = const ::NumberExpression *;
+    using VariableExpression = const ::VariableExpression *;
+    using BinaryOperationExpression = const ::BinaryOperationExpression *;
+
+    template <class Visitor>
+    static void dispatch(Statement statement, Visitor &&visitor);
+    template <class Visitor>
+    static decltype(auto) dispatch(Expression expression, Visitor &&visitor);
+};
 
-  protected:
-    virtual void visit(const Program *program) = 0;
-    virtual void visit(const Block *block) = 0;
-    virtual void visit(const IfStatement *if_statement) = 0;
-    virtual void visit(const LoopStatement *loop_statement) = 0;
-    virtual void visit(const PrintStatement *print_statement) = 0;
-    virtual void visit(const ReadStatement *read_statement) = 0;
-    virtual void visit(const AssignmentStatement *assignment_statement) = 0;
-    virtual void visit(const BreakStatement *break_statement) = 0;
+// Dispatches every node to the matching 'visit' overload of 'Derived' with a single jump on the kind of the node. There
+// are no virtual calls. 'Derived' has to provide overloads for all concrete node types and make them accessible to
+// this class if they are not public.
+template <class Derived, class ExpressionReturnType, class Nodes = TreeNodes>
+class ASTVisitor {
 
   public:
-    ExpressionReturnType visit(const Expression *expression);
+    void visit(typename Nodes::Statement statement) {
+        Nodes::dispatch(statement, [this](auto node) {
+            derived().visit(node);
+        });
+    }
+
+    ExpressionReturnType visit(typename Nodes::Expression expression) {
+        return Nodes::dispatch(expression, [this](auto node) -> ExpressionReturnType {
+            return derived().visit(node);
+        });
+    }
 
-  protected:
-    virtual ExpressionReturnType visit(const NumberExpression *number_expression) = 0;
-    virtual ExpressionReturnType visit(const VariableExpression *variable_expression) = 0;
-    virtual ExpressionReturnType visit(const BinaryOperationExpression *binary_operation_expression) = 0;
+  private:
+    Derived &derived() {
+        return static_cast<Derived &>(*this);
+    }
 };
 
-template <class ExpressionReturnType>
-void ASTVisitor<ExpressionReturnType>::visit(const Statement *statement) {
-    if (auto program = llvm::dyn_cast<Program>(statement)) {
-        visit(program);
-    } else if (auto block = llvm::dyn_cast<Block>(statement)) {
-        visit(block);
-    } else if (auto if_statement = llvm::dyn_cast<IfStatement>(statement)) {
-        visit(if_statement);
-    } else if (auto loop_statement = llvm::dyn_cast<LoopStatement>(statement)) {
-        visit(loop_statement);
-    } else if (auto print_statement = llvm::dyn_cast<PrintStatement>(statement)) {
-        visit(print_statement);
-    } else if (auto read_statement = llvm::dyn_cast<ReadStatement>(statement)) {
-        visit(read_statement);
-    } else if (auto assignment_statement = llvm::dyn_cast<AssignmentStatement>(statement)) {
-        visit(assignment_statement);
-    } else if (auto break_statement = llvm::dyn_cast<BreakStatement>(statement)) {
-        visit(break_statement);
-    } else {
-        throw std::logic_error("Unknown 'Statement' type.");
+template <class Visitor>
+void TreeNodes::dispatch(Statement statement, Visitor &&visitor) {
+    switch (statement->get_kind()) {
+        case ::Statement::program_stm:
+            return visitor(static_cast<Program>(statement));
+        case ::Statement::block_stm:
+            return visitor(static_cast<Block>(statement));
+        case ::Statement::if_stm:
+            return visitor(static_cast<IfStatement>(statement));
+        case ::Statement::loop_stm:
+            return visitor(static_cast<LoopStatement>(statement));
+        case ::Statement::print_stm:
+            return visitor(static_cast<PrintStatement>(statement));
+        case ::Statement::read_stm:
+            return visitor(static_cast<ReadStatement>(statement));
+        case ::Statement::assignment_stm:
+            return visitor(static_cast<AssignmentStatement>(statement));
+        case ::Statement::break_stm:
+            return visitor(static_cast<BreakStatement>(statement));
     }
+    throw std::logic_error("Unknown 'Statement' type.");
 }
 
-template <class ExpressionReturnType>
-ExpressionReturnType ASTVisitor<ExpressionReturnType>::visit(const Expression *expression) {
-    if (auto number_expression = llvm::dyn_cast<NumberExpression>(expression)) {
-        return visit(number_expression);
+template <class Visitor>
+decltype(auto) TreeNodes::dispatch(Expression expression, Visitor &&visitor) {
+    switch (expression->get_kind()) {
+        case ::Expression::number_expr:
+            return visitor(static_cast<NumberExpression>(expression));
+        case ::Expression::variable_expr:
+            return visitor(static_cast<VariableExpression>(expression));
+        case ::Expression::binary_operation_expr:
+            return visitor(static_cast<BinaryOperationExpression>(expression));
     }
-    if (auto variable_expression = llvm::dyn_cast<VariableExpression>(expression)) {
-        return visit(variable_expression);
+    throw std::logic_error("Unknown 'Expression' type.");
+}
+
+// Computes a value for an expression, which may also be a binary operation of 'Nodes', bottom-up. Operands are visited
+// in post-order on explicit stacks instead of recursively, so deeply nested expressions do not exhaust the call stack.
+// 'leaf' returns the value of a number or variable. 'combine' returns the value of a binary operation as soon as those
+// of both of its operands are available, and learns whether the operation is the outermost one.
+template <class Nodes, class Value, class Root, class Leaf, class Combine>
+Value visit_post_order(const Root root, Leaf &&leaf, Combine &&combine) {
+    using PendingExpression = std::variant<typename Nodes::Expression, typename Nodes::BinaryOperationExpression>;
+    llvm::SmallVector<PendingExpression, 16> pending_expressions;
+    llvm::SmallVector<Value, 16> values;
+    auto visit_node = [&](auto node) {
+        if constexpr (std::is_same_v<decltype(node), typename Nodes::BinaryOperationExpression>) {
+            pending_expressions.insert(pending_expressions.end(), {node, node->right_expression, node->left_expression});
+        } else {
+            values.push_back(leaf(node));
+        }
+    };
+    if constexpr (std::is_same_v<Root, typename Nodes::BinaryOperationExpression>) {
+        visit_node(root);
+    } else {
+        Nodes::dispatch(typename Nodes::Expression(root), visit_node);
     }
-    if (auto binary_operation_expression = llvm::dyn_cast<BinaryOperationExpression>(expression)) {
-        return visit(binary_operation_expression);
+    while (!pending_expressions.empty()) {
+        auto pending_expression = pending_expressions.pop_back_val();
+        if (auto *operation = std::get_if<typename Nodes::BinaryOperationExpression>(&pending_expression)) {
+            auto rhs = values.pop_back_val();
+            values.back() = combine(*operation, values.back(), rhs, pending_expressions.empty());
+            continue;
+        }
+        Nodes::dispatch(std::get<typename Nodes::Expression>(pending_expression), visit_node);
     }
-    throw std::logic_error("Unknown 'Expression' type.");
+    return values.back();
 }
 
 #endif
@@ -1,9 +1,9 @@
 #ifndef EXPRESSION_HPP
 #define EXPRESSION_HPP
 
+#include "lexer/SymbolTable.hpp"
+
 #include <cstdint>
-#include <memory>
-#include <string>
 
 #define CLASS_OF_EXPRESSION(kind)                      \
     static bool classof(const Expression *statement) { \
@@ -11,10 +11,8 @@
     }
 
 struct Expression {
-  protected:
     enum Kind { number_expr, variable_expr, binary_operation_expr };
 
-  public:
     Expression(Kind kind)
       : kind(kind) {}
 
@@ -22,8 +20,6 @@ struct Expression {
         return kind;
     }
 
-    virtual ~Expression() = default;
-
   private:
     const Kind kind;
 };
@@ -39,27 +35,25 @@ struct NumberExpression : public Expression {
 };
 
 struct VariableExpression : public Expression {
-    std::string name;
+    SymbolID symbol;
 
-    explicit VariableExpression(std::string name)
+    explicit VariableExpression(SymbolID symbol)
       : Expression(variable_expr)
-      , name(std::move(name)) {}
+      , symbol(symbol) {}
 
     CLASS_OF_EXPRESSION(variable_expr)
 };
 
 struct BinaryOperationExpression : public Expression {
     char operator_symbol;
-    std::unique_ptr<Expression> left_expression;
-    std::unique_ptr<Expression> right_expression;
+    Expression *left_expression;
+    Expression *right_expression;
 
-    BinaryOperationExpression(char operator_symbol,
-                              std::unique_ptr<Expression> left_expression,
-                              std::unique_ptr<Expression> right_expression)
+    BinaryOperationExpression(char operator_symbol, Expression *left_expression, Expression *right_expression)
       : Expression(binary_operation_expr)
       , operator_symbol(operator_symbol)
-      , left_expression(std::move(left_expression))
-      , right_expression(std::move(right_expression)) {}
+      , left_expression(left_expression)
+      , right_expression(right_expression) {}
 
     CLASS_OF_EXPRESSION(binary_operation_expr)
 };
@@ -0,0 +1,330 @@
+#ifndef FLATAST_HPP
+#define FLATAST_HPP
+
+#include "ast/Statement.hpp"
+
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+using NodeIndex = std::uint32_t;
+
+// A compact encoding of a parsed program as a struct of arrays. Nodes are stored in pre-order, so every node is
+// directly followed by its children and a linear scan visits the whole tree. Every node knows where its subtree ends,
+// which is also where its next sibling starts.
+//
+// The nested types are handles decoding one node at a time. They mirror the members of the pointer-based nodes, which
+// lets visitors run over both representations (see 'ASTVisitor').
+class FlatAST {
+
+  public:
+    enum class Kind : std::uint8_t {
+        program,
+        block,
+        if_statement,
+        loop_statement,
+        print_statement,
+        read_statement,
+        assignment_statement,
+        break_statement,
+        number_expression,
+        variable_expression,
+        binary_operation_expression,
+    };
+
+  private:
+    std::vector<Kind> kinds;
+    std::vector<NodeIndex> subtree_ends;
+    std::vector<std::int32_t> payloads;
+
+  public:
+    explicit FlatAST(const ::Program *program);
+
+    struct Statement;
+    struct Expression;
+    struct Program;
+    struct Block;
+    struct IfStatement;
+    struct LoopStatement;
+    struct PrintStatement;
+    struct ReadStatement;
+    struct AssignmentStatement;
+    struct BreakStatement;
+    struct NumberExpression;
+    struct VariableExpression;
+    struct BinaryOperationExpression;
+
+    [[nodiscard]] Statement get_root() const;
+
+    [[nodiscard]] std::size_t size() const {
+        return kinds.size();
+    }
+    [[nodiscard]] std::size_t get_allocated_bytes() const {
+        return kinds.capacity() * sizeof(Kind) + subtree_ends.capacity() * sizeof(NodeIndex) +
+               payloads.capacity() * sizeof(std::int32_t);
+    }
+
+    bool operator==(const FlatAST &other) const = default;
+
+    template <class Visitor>
+    static void dispatch(Statement statement, Visitor &&visitor);
+    template <class Visitor>
+    static decltype(auto) dispatch(Expression expression, Visitor &&visitor);
+
+  private:
+    NodeIndex append(Kind kind, std::int32_t payload = 0);
+};
+
+struct FlatAST::Statement {
+    const FlatAST *ast = nullptr;
+    NodeIndex index = 0;
+};
+
+struct FlatAST::Expression {
+    const FlatAST *ast = nullptr;
+    NodeIndex index = 0;
+};
+
+struct FlatAST::Block {
+    class Statements {
+        const FlatAST *ast = nullptr;
+        NodeIndex first_index = 0;
+        NodeIndex end_index = 0;
+
+      public:
+        class iterator {
+            const FlatAST *ast = nullptr;
+            NodeIndex index = 0;
+
+          public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = FlatAST::Statement;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const FlatAST::Statement *;
+            using reference = FlatAST::Statement;
+
+            iterator() = default;
+            iterator(const FlatAST *ast, NodeIndex index)
+              : ast(ast)
+              , index(index) {}
+
+            FlatAST::Statement operator*() const {
+                return {ast, index};
+            }
+            iterator &operator++() {
+                index = ast->subtree_ends[index];
+                return *this;
+            }
+            iterator operator++(int) {
+                auto previous = *this;
+                ++(*this);
+                return previous;
+            }
+            bool operator==(const iterator &other) const {
+                return index == other.index;
+            }
+        };
+
+        Statements() = default;
+        Statements(const FlatAST *ast, NodeIndex first_index, NodeIndex end_index)
+          : ast(ast)
+          , first_index(first_index)
+          , end_index(end_index) {}
+
+        [[nodiscard]] iterator begin() const {
+            return {ast, first_index};
+        }
+        [[nodiscard]] iterator end() const {
+            return {ast, end_index};
+        }
+    };
+
+    const FlatAST *ast = nullptr;
+    NodeIndex index = 0;
+    Statements statements;
+
+    Block() = default;
+    Block(const FlatAST &ast, NodeIndex index)
+      : ast(&ast)
+      , index(index)
+      , statements(&ast, index + 1, ast.subtree_ends[index]) {}
+
+    explicit operator bool() const {
+        return ast != nullptr;
+    }
+    const Block *operator->() const {
+        return this;
+    }
+};
+
+struct FlatAST::Program {
+    NodeIndex index;
+    Block block;
+
+    Program(const FlatAST &ast, NodeIndex index)
+      : index(index)
+      , block(ast, index + 1) {}
+
+    const Program *operator->() const {
+        return this;
+    }
+};
+
+struct FlatAST::NumberExpression {
+    std::int32_t value;
+
+    NumberExpression(const FlatAST &ast, NodeIndex index)
+      : value(ast.payloads[index]) {}
+
+    const NumberExpression *operator->() const {
+        return this;
+    }
+};
+
+struct FlatAST::VariableExpression {
+    SymbolID symbol;
+
+    VariableExpression(const FlatAST &ast, NodeIndex index)
+      : symbol(static_cast<SymbolID>(ast.payloads[index])) {}
+
+    const VariableExpression *operator->() const {
+        return this;
+    }
+};
+
+struct FlatAST::BinaryOperationExpression {
+    char operator_symbol;
+    Expression left_expression;
+    Expression right_expression;
+
+    BinaryOperationExpression(const FlatAST &ast, NodeIndex index)
+      : operator_symbol(static_cast<char>(ast.payloads[index]))
+      , left_expression{&ast, index + 1}
+      , right_expression{&ast, ast.subtree_ends[index + 1]} {}
+
+    const BinaryOperationExpression *operator->() const {
+        return this;
+    }
+};
+
+struct FlatAST::IfStatement {
+    IfStatementType type;
+    Expression expression;
+    Block then_block;
+    Block else_block;
+
+    IfStatement(const FlatAST &ast, NodeIndex index)
+      : type(static_cast<IfStatementType>(ast.payloads[index]))
+      , expression{&ast, index + 1}
+      , then_block(ast, ast.subtree_ends[index + 1]) {
+        auto then_block_end = ast.subtree_ends[then_block.index];
+        if (then_block_end != ast.subtree_ends[index]) {
+            else_block = Block(ast, then_block_end);
+        }
+    }
+
+    const IfStatement *operator->() const {
+        return this;
+    }
+};
+
+struct FlatAST::LoopStatement {
+    Block block;
+
+    LoopStatement(const FlatAST &ast, NodeIndex index)
+      : block(ast, index + 1) {}
+
+    const LoopStatement *operator->() const {
+        return this;
+    }
+};
+
+struct FlatAST::PrintStatement {
+    Expression expression;
+
+    PrintStatement(const FlatAST &ast, NodeIndex index)
+      : expression{&ast, index + 1} {}
+
+    const PrintStatement *operator->() const {
+        return this;
+    }
+};
+
+struct FlatAST::ReadStatement {
+    VariableExpression variable_expression;
+
+    ReadStatement(const FlatAST &ast, NodeIndex index)
+      : variable_expression(ast, index + 1) {}
+
+    const ReadStatement *operator->() const {
+        return this;
+    }
+};
+
+struct FlatAST::AssignmentStatement {
+    VariableExpression variable;
+    Expression expression;
+
+    AssignmentStatement(const FlatAST &ast, NodeIndex index)
+      : variable(ast, index + 1)
+      , expression{&ast, index + 2} {}
+
+    const AssignmentStatement *operator->() const {
+        return this;
+    }
+};
+
+struct FlatAST::BreakStatement {
+    BreakStatement(const FlatAST & /*ast*/, NodeIndex /*index*/) {}
+
+    const BreakStatement *operator->() const {
+        return this;
+    }
+};
+
+inline FlatAST::Statement FlatAST::get_root() const {
+    return {this, 0};
+}
+
+template <class Visitor>
+void FlatAST::dispatch(const Statement statement, Visitor &&visitor) {
+    const auto &ast = *statement.ast;
+    switch (ast.kinds[statement.index]) {
+        case Kind::program:
+            return visitor(Program(ast, statement.index));
+        case Kind::block:
+            return visitor(Block(ast, statement.index));
+        case Kind::if_statement:
+            return visitor(IfStatement(ast, statement.index));
+        case Kind::loop_statement:
+            return visitor(LoopStatement(ast, statement.index));
+        case Kind::print_statement:
+            return visitor(PrintStatement(ast, statement.index));
+        case Kind::read_statement:
+            return visitor(ReadStatement(ast, statement.index));
+        case Kind::assignment_statement:
+            return visitor(AssignmentStatement(ast, statement.index));
+        case Kind::break_statement:
+            return visitor(BreakStatement(ast, statement.index));
+        default:
+            throw std::logic_error("Unknown 'Statement' type.");
+    }
+}
+
+template <class Visitor>
+decltype(auto) FlatAST::dispatch(const Expression expression, Visitor &&visitor) {
+    const auto &ast = *expression.ast;
+    switch (ast.kinds[expression.index]) {
+        case Kind::number_expression:
+            return visitor(NumberExpression(ast, expression.index));
+        case Kind::variable_expression:
+            return visitor(VariableExpression(ast, expression.index));
+        case Kind::binary_operation_expression:
+            return visitor(BinaryOperationExpression(ast, expression.index));
+        default:
+            throw std::logic_error("Unknown 'Expression' type.");
+    }
+}
+
+#endif
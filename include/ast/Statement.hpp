@@ -3,8 +3,7 @@
 
 #include "ast/Expression.hpp"
 
-#include <memory>
-#include <vector>
+#include "llvm/ADT/ArrayRef.h"
 
 enum class IfStatementType : char { zero = 'Z', positive = 'P', negative = 'N' };
 
@@ -14,10 +13,8 @@ enum class IfStatementType : char { zero = 'Z', positive = 'P', negative = 'N' }
     }
 
 struct Statement {
-  protected:
     enum Kind { block_stm, program_stm, if_stm, loop_stm, print_stm, read_stm, assignment_stm, break_stm };
 
-  public:
     Statement(Kind kind)
       : kind(kind) {}
 
@@ -25,89 +22,84 @@ struct Statement {
         return kind;
     }
 
-    virtual ~Statement() = default;
-
   private:
     const Kind kind;
 };
 
 struct Block : public Statement {
-    std::vector<std::unique_ptr<Statement>> statements;
+    llvm::ArrayRef<Statement *> statements;
 
-    explicit Block(std::vector<std::unique_ptr<Statement>> statements)
+    explicit Block(llvm::ArrayRef<Statement *> statements)
       : Statement(block_stm)
-      , statements(std::move(statements)) {}
+      , statements(statements) {}
 
     CLASS_OF_STATEMENT(block_stm)
 };
 
 struct Program : public Statement {
-    std::unique_ptr<Block> block;
+    Block *block;
 
-    explicit Program(std::unique_ptr<Block> block)
+    explicit Program(Block *block)
       : Statement(program_stm)
-      , block(std::move(block)) {}
+      , block(block) {}
 
     CLASS_OF_STATEMENT(program_stm)
 };
 
 struct IfStatement : public Statement {
     IfStatementType type;
-    std::unique_ptr<Expression> expression;
-    std::unique_ptr<Block> then_block;
-    std::unique_ptr<Block> else_block;
-
-    IfStatement(const IfStatementType type,
-                std::unique_ptr<Expression> expression,
-                std::unique_ptr<Block> then_block,
-                std::unique_ptr<Block> else_block = nullptr)
+    Expression *expression;
+    Block *then_block;
+    Block *else_block;
+
+    IfStatement(const IfStatementType type, Expression *expression, Block *then_block, Block *else_block = nullptr)
       : Statement(if_stm)
       , type(type)
-      , expression(std::move(expression))
-      , then_block(std::move(then_block))
-      , else_block(std::move(else_block)) {}
+      , expression(expression)
+      , then_block(then_block)
+      , else_block(else_block) {}
 
     CLASS_OF_STATEMENT(if_stm)
 };
 
 struct LoopStatement : public Statement {
-    std::unique_ptr<Block> block;
+    Block *block;
 
-    explicit LoopStatement(std::unique_ptr<Block> block)
+    explicit LoopStatement(Block *block)
       : Statement(loop_stm)
-      , block(std::move(block)) {}
+      , block(block) {}
 
     CLASS_OF_STATEMENT(loop_stm)
 };
 
 struct PrintStatement : public Statement {
-    std::unique_ptr<Expression> expression;
+    Expression *expression;
 
-    explicit PrintStatement(std::unique_ptr<Expression> expression)
+    explicit PrintStatement(Expression *expression)
       : Statement(print_stm)
-      , expression(std::move(expression)) {}
+      , expression(expression) {}
 
     CLASS_OF_STATEMENT(print_stm)
 };
 
 struct ReadStatement : public Statement {
-    std::unique_ptr<VariableExpression> variable_expression;
+    VariableExpression *variable_expression;
 
-    explicit ReadStatement(std::unique_ptr<VariableExpression> variable_expression)
+    explicit ReadStatement(VariableExpression *variable_expression)
       : Statement(read_stm)
-      , variable_expression(std::move(variable_expression)) {}
+      , variable_expression(variable_expression) {}
 
     CLASS_OF_STATEMENT(read_stm)
 };
 
 struct AssignmentStatement : public Statement {
-    std::unique_ptr<VariableExpression> variable;
-    std::unique_ptr<Expression> expression;
+    VariableExpression *variable;
+    Expression *expression;
 
-    AssignmentStatement(std::unique_ptr<VariableExpression> variable, std::unique_ptr<Expression> expression)
+    AssignmentStatement(VariableExpression *variable, Expression *expression)
       : Statement(assignment_stm)
-      , variable(std::move(variable))
-      , expression(std::move(expression)) {}
+      , variable(variable)
+      , expression(expression) {}
 
     CLASS_OF_STATEMENT(assignment_stm)
 };
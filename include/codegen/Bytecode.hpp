@@ -0,0 +1,46 @@
+#ifndef BYTECODE_HPP
+#define BYTECODE_HPP
+
+#include <cstdint>
+#include <vector>
+
+using Register = std::uint32_t;
+
+// One instruction of a register machine. Operations read their operands from the registers 'lhs' and 'rhs' and write
+// their result to 'target'. Jumps continue at the instruction with the index 'target', conditional jumps only if the
+// register 'lhs' does not satisfy their condition. A 'jump_back' starts the next iteration of the loop numbered 'lhs'.
+//
+// Variables are registers themselves, so an assignment like 'x = x + 1' is a single 'add' loading, computing and
+// storing at once. Comparing with zero and branching is a single instruction, too.
+struct Instruction {
+    enum class Opcode : std::uint8_t {
+        add,
+        subtract,
+        multiply,
+        divide,
+        remainder,
+        move,
+        print,
+        read,
+        jump,
+        jump_back,
+        jump_unless_zero,
+        jump_unless_positive,
+        jump_unless_negative,
+        halt,
+    };
+
+    Opcode opcode;
+    Register target = 0;
+    Register lhs = 0;
+    Register rhs = 0;
+};
+
+// A program lowered for the 'Interpreter'. The registers hold their initial values: variables and temporaries start
+// as zero, while the remaining registers hold the constants used by the instructions.
+struct Bytecode {
+    std::vector<Instruction> instructions;
+    std::vector<std::int32_t> registers;
+};
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef BYTECODEGENERATOR_HPP
+#define BYTECODEGENERATOR_HPP
+
+#include "ast/ASTVisitor.hpp"
+#include "codegen/Bytecode.hpp"
+
+#include "llvm/ADT/SmallVector.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Lowers a program to the 'Bytecode' run by the 'Interpreter'. The structure follows the 'CodeGenerator', only that
+// instructions are appended to the bytecode instead of LLVM IR.
+template <class Nodes = TreeNodes>
+class BytecodeGenerator : public ASTVisitor<BytecodeGenerator<Nodes>, Register, Nodes> {
+    Bytecode &bytecode;
+
+    bool had_break;
+
+    std::unordered_map<std::int32_t, Register> constants;
+
+    // Temporaries are numbered from zero while generating and moved behind all other registers in the end.
+    Register temporary_count;
+    Register max_temporary_count;
+
+    // Loops are numbered in the order they are generated, just like by the 'CodeGenerator'.
+    Register loop_count;
+    // Indices of the jumps leaving the enclosing loops, innermost last.
+    std::vector<llvm::SmallVector<std::size_t, 4>> loop_breaks;
+
+    // Nested statements are scheduled like in the 'CodeGenerator'.
+    std::vector<std::function<void()>> pending_tasks;
+
+  public:
+    BytecodeGenerator(Bytecode &bytecode, const SymbolTable &symbols);
+
+    using ASTVisitor<BytecodeGenerator, Register, Nodes>::visit;
+
+  private:
+    friend ASTVisitor<BytecodeGenerator, Register, Nodes>;
+
+    void visit(typename Nodes::Program program);
+    void visit(typename Nodes::Block block);
+    void visit(typename Nodes::IfStatement if_statement);
+    void visit(typename Nodes::LoopStatement loop_statement);
+    void visit(typename Nodes::PrintStatement print_statement);
+    void visit(typename Nodes::ReadStatement read_statement);
+    void visit(typename Nodes::AssignmentStatement assignment_statement);
+    void visit(typename Nodes::BreakStatement break_statement);
+
+    Register visit(typename Nodes::NumberExpression number_expression);
+    Register visit(typename Nodes::VariableExpression variable_expression);
+    Register visit(typename Nodes::BinaryOperationExpression binary_operation_expression);
+
+    template <class Task>
+    void schedule(Task &&task) {
+        pending_tasks.emplace_back(std::forward<Task>(task));
+    }
+    template <class Node>
+    void schedule_visit(Node node) {
+        schedule([this, node]() {
+            visit(node);
+        });
+    }
+    template <class StatementIterator>
+    void visit_statements(StatementIterator current, StatementIterator end);
+
+    Register create_operations(typename Nodes::BinaryOperationExpression binary_operation_expression,
+                               std::optional<Register> result);
+    std::size_t create_instruction(Instruction instruction);
+    void set_jump_target(std::size_t jump);
+    Register create_temporary();
+    void release(Register value);
+    void relocate_temporaries();
+};
+
+#endif
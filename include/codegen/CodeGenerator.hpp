@@ -3,48 +3,125 @@
 
 #include "ast/ASTVisitor.hpp"
 
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
 #include "llvm/IR/Module.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <stack>
+#include <utility>
+#include <vector>
 
-class CodeGenerator : public ASTVisitor<llvm::Value *> {
+template <class Nodes = TreeNodes>
+class CodeGenerator : public ASTVisitor<CodeGenerator<Nodes>, llvm::Value *, Nodes> {
     llvm::Module &module;
 
     llvm::IRBuilder<> builder;
 
     bool had_break;
 
-    llvm::Value *read_template;
-    llvm::Value *print_template;
-
     llvm::Function *main_function;
     llvm::BasicBlock *main_block;
 
-    llvm::StringMap<llvm::Value *> known_variables;
+    // A resumable 'main' takes the values of all variables and the loop to continue in, which the 'TieredExecutor' uses
+    // to take over a program from the 'Interpreter'. Loops are numbered in the order they are generated.
+    bool resumable;
+    llvm::BasicBlock *start_block;
+    std::uint32_t loop_count;
+
+    // With checked divisions, dividing by zero or the smallest number by -1 makes 'main' return 'bitsy_division_error'
+    // from a block shared by all divisions instead of trapping, which would end the embedding process.
+    bool checked_division;
+    llvm::BasicBlock *division_error_block;
+
+    const SymbolTable &symbols;
+
+    // Variables live in registers right away, following Braun et al., "Simple and Efficient Construction of Static
+    // Single Assignment Form". Every block knows the values its variables have at its end. A block is sealed once all
+    // of its predecessors exist; before that, reading a variable in it creates a phi node completed when sealing.
+    std::vector<llvm::DenseMap<llvm::BasicBlock *, llvm::Value *>> definitions;
+    llvm::DenseSet<llvm::BasicBlock *> sealed_blocks;
+    llvm::DenseMap<llvm::BasicBlock *, llvm::SmallVector<std::pair<SymbolID, llvm::PHINode *>, 4>> incomplete_phis;
+    // Phi nodes still missing operands must not be removed as trivial.
+    llvm::DenseSet<llvm::PHINode *> unfinished_phis;
+    // Removed phi nodes stay alive and forward to their replacement. Updating all definitions referring to them instead
+    // would take quadratic time in deeply nested loops, where the same definition is replaced again and again.
+    llvm::DenseMap<llvm::PHINode *, llvm::Value *> replaced_phis;
+    std::vector<std::unique_ptr<llvm::PHINode>> removed_phis;
+
     std::stack<llvm::BasicBlock *> loop_continuation_hierarchy;
 
+    // Work left to do, most recent first. Nested statements are scheduled here instead of being visited recursively,
+    // so deeply nested programs do not exhaust the call stack.
+    std::vector<std::function<void()>> pending_tasks;
+
   public:
-    explicit CodeGenerator(llvm::Module &module);
+    CodeGenerator(llvm::Module &module,
+                  const SymbolTable &symbols,
+                  bool resumable = false,
+                  bool checked_division = false);
 
-    using ASTVisitor<llvm::Value *>::visit;
+    using ASTVisitor<CodeGenerator, llvm::Value *, Nodes>::visit;
 
   private:
-    void visit(const Program *program) override;
-    void visit(const Block *block) override;
-    void visit(const IfStatement *if_statement) override;
-    void visit(const LoopStatement *loop_statement) override;
-    void visit(const PrintStatement *print_statement) override;
-    void visit(const ReadStatement *read_statement) override;
-    void visit(const AssignmentStatement *assignment_statement) override;
-    void visit(const BreakStatement *break_statement) override;
-
-    llvm::Value *visit(const NumberExpression *number_expression) override;
-    llvm::Value *visit(const VariableExpression *variable_expression) override;
-    llvm::Value *visit(const BinaryOperationExpression *binary_operation_expression) override;
-
-    llvm::Value *allocate_variable(const std::string &name);
-    llvm::Value *create_if_condition(const IfStatement *if_statement);
+    friend ASTVisitor<CodeGenerator, llvm::Value *, Nodes>;
+
+    void visit(typename Nodes::Program program);
+    void visit(typename Nodes::Block block);
+    void visit(typename Nodes::IfStatement if_statement);
+    void visit(typename Nodes::LoopStatement loop_statement);
+    void visit(typename Nodes::PrintStatement print_statement);
+    void visit(typename Nodes::ReadStatement read_statement);
+    void visit(typename Nodes::AssignmentStatement assignment_statement);
+    void visit(typename Nodes::BreakStatement break_statement);
+
+    llvm::Value *visit(typename Nodes::NumberExpression number_expression);
+    llvm::Value *visit(typename Nodes::VariableExpression variable_expression);
+    llvm::Value *visit(typename Nodes::BinaryOperationExpression binary_operation_expression);
+
+    template <class Task>
+    void schedule(Task &&task) {
+        pending_tasks.emplace_back(std::forward<Task>(task));
+    }
+    template <class Node>
+    void schedule_visit(Node node) {
+        schedule([this, node]() {
+            visit(node);
+        });
+    }
+    template <class StatementIterator>
+    void visit_statements(StatementIterator current, StatementIterator end);
+
+    llvm::Value *create_binary_operation(char operator_symbol, llvm::Value *lhs, llvm::Value *rhs);
+    llvm::Value *create_checked_division(char operator_symbol, llvm::Value *lhs, llvm::Value *rhs);
+
+    // A phi node whose operands are being looked up in the predecessors of its block. Lookups are tracked on an explicit
+    // stack rather than by recursion, since long chains of blocks would exhaust the call stack.
+    struct PendingPhi {
+        llvm::PHINode *phi;
+        llvm::SmallVector<llvm::BasicBlock *, 4> blocks;
+        llvm::SmallVector<llvm::BasicBlock *, 2> predecessors;
+        std::size_t next_predecessor;
+    };
+
+    void write_variable(SymbolID symbol, llvm::BasicBlock *block, llvm::Value *value);
+    llvm::Value *read_variable(SymbolID symbol, llvm::BasicBlock *block);
+    llvm::Value *look_up_variable(SymbolID symbol,
+                                  llvm::BasicBlock *block,
+                                  llvm::SmallVectorImpl<PendingPhi> &pending_phis);
+    llvm::Value *get_initial_value(SymbolID symbol);
+    llvm::PHINode *create_phi(SymbolID symbol, llvm::BasicBlock *block);
+    llvm::Value *resolve(llvm::Value *value);
+    llvm::Value *remove_trivial_phi(llvm::PHINode *phi);
+    void seal_block(llvm::BasicBlock *block);
+    void create_flush();
+    llvm::Value *create_if_condition(typename Nodes::IfStatement if_statement);
 };
 
 #endif
@@ -1,22 +1,48 @@
 #ifndef IRMODULEBUILDER_HPP
 #define IRMODULEBUILDER_HPP
 
+#include "ast/FlatAST.hpp"
 #include "ast/Statement.hpp"
+#include "lexer/SymbolTable.hpp"
 
+#include "llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
 #include "llvm/IR/Module.h"
 
 #include <memory>
+#include <variant>
 
 class ModuleBuilder {
-    const Program *program;
+    std::variant<const Program *, const FlatAST *> program;
+    const SymbolTable &symbols;
+    bool resumable;
+    bool checked_division;
 
-    mutable llvm::LLVMContext context;
+    // Built modules may outlive the builder, e.g. in a JIT compiler, and keep the context alive on their own.
+    mutable llvm::orc::ThreadSafeContext context;
 
   public:
-    ModuleBuilder(const Program *program)
-      : program(program) {}
-
-    [[nodiscard]] std::unique_ptr<llvm::Module> build() const;
+    // A resumable module can continue the program at the start of every loop, one with checked divisions returns instead
+    // of trapping on an invalid division (see 'CodeGenerator').
+    ModuleBuilder(const Program *program,
+                  const SymbolTable &symbols,
+                  const bool resumable = false,
+                  const bool checked_division = false)
+      : program(program)
+      , symbols(symbols)
+      , resumable(resumable)
+      , checked_division(checked_division)
+      , context(std::make_unique<llvm::LLVMContext>()) {}
+    ModuleBuilder(const FlatAST *program,
+                  const SymbolTable &symbols,
+                  const bool resumable = false,
+                  const bool checked_division = false)
+      : program(program)
+      , symbols(symbols)
+      , resumable(resumable)
+      , checked_division(checked_division)
+      , context(std::make_unique<llvm::LLVMContext>()) {}
+
+    [[nodiscard]] llvm::orc::ThreadSafeModule build() const;
 };
 
 #endif
@@ -0,0 +1,48 @@
+#ifndef BATCHCOMPILER_HPP
+#define BATCHCOMPILER_HPP
+
+#include "execution/ModuleProcessor.hpp"
+
+#include "llvm/Passes/OptimizationLevel.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+// Compiles many Bitsy files at once, each of them in a task of its own on a thread pool. A task has its own lexer,
+// parser, LLVM context, target machine and temporary files, so the tasks share nothing but the target registry. The
+// diagnostics of a file are collected while it is compiled and reported in the order of the inputs afterwards.
+class BatchCompiler {
+    std::vector<std::string> input_names;
+    std::vector<std::string> empty_directories;
+    std::string output_directory;
+    OutputKind output_kind;
+    std::optional<llvm::OptimizationLevel> optimization_level;
+    TargetDescription target;
+
+  public:
+    // Directories among the inputs stand for the '.bitsy' files directly contained in them.
+    BatchCompiler(const std::vector<std::string> &inputs,
+                  std::string output_directory,
+                  OutputKind output_kind,
+                  std::optional<llvm::OptimizationLevel> optimization_level,
+                  TargetDescription target);
+
+    // Returns the number of files that could not be compiled. Zero threads mean one per core.
+    [[nodiscard]] unsigned int compile(unsigned int threads, llvm::raw_ostream &diagnostics = llvm::errs()) const;
+    [[nodiscard]] const std::vector<std::string> &get_input_names() const {
+        return input_names;
+    }
+    // Input directories without any '.bitsy' file, which most likely is a mistake.
+    [[nodiscard]] const std::vector<std::string> &get_empty_directories() const {
+        return empty_directories;
+    }
+
+  private:
+    [[nodiscard]] std::string get_output_name(const std::string &input_name) const;
+    [[nodiscard]] bool
+    compile_file(const std::string &input_name, const std::string &output_name, llvm::raw_ostream &diagnostics) const;
+};
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef COMPILATIONCACHE_HPP
+#define COMPILATIONCACHE_HPP
+
+#include "execution/ModuleProcessor.hpp"
+
+#include "llvm/ExecutionEngine/ObjectCache.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Passes/OptimizationLevel.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+
+// An on-disk cache of the native code compiled for one program. Its entries are named after a hash of the source, the
+// bitsyc executable, the optimization level and the target, so a changed input of any kind is a miss. The JIT compiler
+// stores and loads the object file through the 'llvm::ObjectCache' interface, while executables built with '-c' are
+// copied in and out.
+//
+// Entries are written to temporary files and renamed afterwards, so concurrent processes never see partial files.
+// Hits mark their entry as recently used. Once the cache grows beyond its size limit, the least recently used entries
+// are removed.
+class CompilationCache : public llvm::ObjectCache {
+    std::filesystem::path directory;
+    std::uintmax_t size_limit;
+    std::string key;
+
+    // Counted by the users of the cache, once per program served from it or compiled.
+    unsigned int hits = 0;
+    unsigned int misses = 0;
+    unsigned int evictions = 0;
+
+    // Loaded ahead of the JIT compiler asking for it, so that it cannot be evicted in between.
+    std::unique_ptr<llvm::MemoryBuffer> loaded_object;
+
+  public:
+    CompilationCache(std::filesystem::path directory,
+                     std::uintmax_t size_limit,
+                     llvm::StringRef source,
+                     const TargetDescription &target,
+                     std::optional<llvm::OptimizationLevel> optimization_level);
+
+    // Whether the object file is in the cache. The JIT compiler gets the loaded one.
+    [[nodiscard]] bool load_object();
+    void notifyObjectCompiled(const llvm::Module *module, llvm::MemoryBufferRef object) override;
+    std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module *module) override;
+
+    [[nodiscard]] bool retrieve_executable(const std::filesystem::path &output_file);
+    void store_executable(const std::filesystem::path &output_file);
+
+    void count_hit() {
+        ++hits;
+    }
+    void count_miss() {
+        ++misses;
+    }
+    void print_statistics(llvm::raw_ostream &stream) const;
+
+  private:
+    [[nodiscard]] std::filesystem::path get_entry(const char *extension) const;
+    void store(const std::filesystem::path &entry, llvm::StringRef content, bool executable);
+    void evict();
+};
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef INPUTRUNNER_HPP
+#define INPUTRUNNER_HPP
+
+#include "library/CompiledProgram.hpp"
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <string>
+#include <vector>
+
+// Runs one compiled program once per file in a directory, on a thread pool. A run reads its input file in place and
+// writes into an output buffer of its own. The outputs are handed over in the order of the inputs as soon as all runs
+// before them are done, so only those of the runs ahead of the slowest one are kept in memory.
+class InputRunner {
+    const CompiledProgram &program;
+    std::vector<std::string> input_names;
+
+  public:
+    // The inputs are the files directly contained in the directory, sorted by name.
+    InputRunner(const CompiledProgram &program, const std::string &input_directory);
+
+    // Calls the consumer on the calling thread. Returns the number of inputs that could not be read or whose run
+    // failed. Zero threads mean one per core.
+    [[nodiscard]] unsigned int run(unsigned int threads,
+                                   llvm::function_ref<void(const std::string &input_name, llvm::StringRef output)> consume,
+                                   llvm::raw_ostream &diagnostics = llvm::errs()) const;
+    [[nodiscard]] const std::vector<std::string> &get_input_names() const {
+        return input_names;
+    }
+};
+
+#endif
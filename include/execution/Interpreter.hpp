@@ -0,0 +1,31 @@
+#ifndef INTERPRETER_HPP
+#define INTERPRETER_HPP
+
+#include "codegen/Bytecode.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+// Continues a program at the start of the given loop with the given values of all variables. A resumable module
+// compiled by the 'ModuleProcessor' provides such a function.
+using ResumeFunction = int (*)(std::int32_t *variables, std::uint32_t loop);
+
+// Executes bytecode directly. Short programs finish long before the JIT compiler of the 'ModuleProcessor' would have
+// been set up.
+class Interpreter {
+    const Bytecode &bytecode;
+    const std::atomic<ResumeFunction> *resume_function;
+
+  public:
+    explicit Interpreter(const Bytecode &bytecode)
+      : bytecode(bytecode)
+      , resume_function(nullptr) {}
+    // As soon as the given function is set, the program continues in it at the next iteration of a loop.
+    Interpreter(const Bytecode &bytecode, const std::atomic<ResumeFunction> &resume_function)
+      : bytecode(bytecode)
+      , resume_function(&resume_function) {}
+
+    [[nodiscard]] int execute() const;
+};
+
+#endif
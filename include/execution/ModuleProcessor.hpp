@@ -1,27 +1,82 @@
 #ifndef MODULEEXECUTOR_HPP
 #define MODULEEXECUTOR_HPP
 
+#include "llvm/ExecutionEngine/ExecutionEngine.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
+#include "llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Passes/OptimizationLevel.h"
+#include "llvm/Support/CodeGen.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
 
 #include <memory>
+#include <optional>
+#include <string>
+
+namespace llvm::orc {
+class LLLazyJIT;
+} // namespace llvm::orc
+
+// The processor to generate code for, "native" being the host. The comma-separated features, like "+avx2,-avx512f",
+// are enabled or disabled on top of the ones the processor has.
+struct TargetDescription {
+    std::string cpu = "native";
+    std::string features;
+
+    // Whether the processor is known to LLVM for the host's architecture.
+    [[nodiscard]] bool is_supported() const;
+};
+
+// What 'ModuleProcessor::compile' writes to the output file. Only executables are linked.
+enum class OutputKind { executable, object, assembly, bitcode };
 
 class ModuleProcessor {
 
-    std::unique_ptr<llvm::Module> module;
+    llvm::orc::ThreadSafeModule module;
     std::string output_name;
+    std::string cpu;
+    std::string features;
+    // Machine code is generated with the effort matching the optimization of the module.
+    std::optional<llvm::OptimizationLevel> optimization_level;
+    std::unique_ptr<llvm::TargetMachine> target_machine;
+    llvm::ObjectCache *object_cache = nullptr;
 
   public:
-    ModuleProcessor(std::unique_ptr<llvm::Module> module, std::string output_name)
-      : module(std::move(module))
-      , output_name(std::move(output_name)) {}
+    // The module is prepared for the given target right away, so optimizations know about its data layout and its
+    // processor features. Machine code is generated for the same target, be it by the JIT compiler or for an output file.
+    ModuleProcessor(llvm::orc::ThreadSafeModule module,
+                    std::string output_name,
+                    const TargetDescription &target = {});
+
+    // The JIT compiler loads the native code from the cache if it is there and stores it otherwise.
+    void set_object_cache(llvm::ObjectCache *cache) {
+        object_cache = cache;
+    }
 
     void print() const;
-    void optimize();
+    [[nodiscard]] unsigned int get_instruction_count() const;
+    // Runs the standard pipeline of the given level, just like Clang does for C code.
+    void optimize(llvm::OptimizationLevel level = llvm::OptimizationLevel::O2);
 
     [[nodiscard]] bool show_cfg() const;
-    [[nodiscard]] bool verify() const;
-    [[nodiscard]] int compile() const;
-    [[nodiscard]] int execute() const;
+    [[nodiscard]] bool verify(llvm::raw_ostream &diagnostics = llvm::outs()) const;
+    [[nodiscard]] int compile(OutputKind kind = OutputKind::executable,
+                              llvm::raw_ostream &diagnostics = llvm::errs()) const;
+    // Hands the module over to the returned JIT compiler, so it must be the last use of the processor.
+    [[nodiscard]] std::unique_ptr<llvm::orc::LLLazyJIT> create_jit();
+    // Compiles the program in the JIT compiler as far as needed to call its 'main'.
+    [[nodiscard]] static llvm::Expected<int (*)()> find_main(llvm::orc::LLLazyJIT &jit);
+    [[nodiscard]] int execute();
+    // Compiles a copy of the module to native code, which lives as long as the returned engine.
+    [[nodiscard]] std::unique_ptr<llvm::ExecutionEngine> create_engine() const;
+
+  private:
+    [[nodiscard]] llvm::CodeGenOpt::Level get_codegen_optimization_level() const;
+    [[nodiscard]] std::unique_ptr<llvm::TargetMachine> create_target_machine() const;
+    [[nodiscard]] bool
+    emit(llvm::raw_pwrite_stream &stream, llvm::CodeGenFileType file_type, llvm::raw_ostream &diagnostics) const;
 };
 
 #endif
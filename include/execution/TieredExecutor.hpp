@@ -0,0 +1,47 @@
+#ifndef TIEREDEXECUTOR_HPP
+#define TIEREDEXECUTOR_HPP
+
+#include "codegen/Bytecode.hpp"
+#include "codegen/ModuleBuilder.hpp"
+#include "execution/Interpreter.hpp"
+#include "execution/ModuleProcessor.hpp"
+
+#include "llvm/ExecutionEngine/ExecutionEngine.h"
+#include "llvm/Passes/OptimizationLevel.h"
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <thread>
+
+// Starts a program in the 'Interpreter' right away while the resumable module of the given builder is optimized and
+// compiled on a background thread. Once the native code is ready, it takes over at the next iteration of a loop
+// together with the current values of all variables. Short programs thus never wait for the compiler, while long
+// running ones still end up in optimized code.
+class TieredExecutor {
+    const Bytecode &bytecode;
+    const ModuleBuilder &builder;
+    std::optional<llvm::OptimizationLevel> optimization_level;
+    TargetDescription target;
+
+    std::unique_ptr<llvm::ExecutionEngine> engine;
+    std::atomic<ResumeFunction> resume_function;
+    std::thread compiler;
+
+  public:
+    TieredExecutor(const Bytecode &bytecode,
+                   const ModuleBuilder &builder,
+                   std::optional<llvm::OptimizationLevel> optimization_level,
+                   TargetDescription target = {});
+    TieredExecutor(const TieredExecutor &) = delete;
+    TieredExecutor &operator=(const TieredExecutor &) = delete;
+    // Waits for the compilation to finish, even if the program does not need it anymore.
+    ~TieredExecutor();
+
+    [[nodiscard]] int execute();
+
+  private:
+    void compile();
+};
+
+#endif
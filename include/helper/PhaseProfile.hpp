@@ -0,0 +1,65 @@
+#ifndef PHASEPROFILE_HPP
+#define PHASEPROFILE_HPP
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Records the wall and CPU time of the phases of a compiler run with LLVM's timers, together with the net change of the
+// heap in each phase and the peak memory of the process at its end. Counters collect sizes along the way, like the
+// number of tokens. Phases and counters are reported in the order they first appear, as text or as JSON.
+class PhaseProfile {
+    struct Phase {
+        std::string name;
+        std::unique_ptr<llvm::Timer> timer;
+        // What the phase leaves allocated, which is negative if it frees more than it allocates.
+        std::int64_t heap_delta_bytes = 0;
+        std::uint64_t peak_memory_bytes = 0;
+    };
+
+    llvm::TimerGroup timer_group{"bitsyc", "Phases of bitsyc"};
+    std::vector<Phase> phases;
+    std::vector<std::pair<std::string, std::uint64_t>> counters;
+
+  public:
+    // Measures a phase until it goes out of scope. A scope without a profile measures nothing.
+    class Scope {
+        PhaseProfile *profile = nullptr;
+        std::size_t phase_index = 0;
+        std::size_t start_heap_bytes = 0;
+
+      public:
+        Scope() = default;
+        Scope(PhaseProfile *profile, std::size_t phase_index);
+        Scope(Scope &&other) noexcept
+          : profile(std::exchange(other.profile, nullptr))
+          , phase_index(other.phase_index)
+          , start_heap_bytes(other.start_heap_bytes) {}
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+        Scope &operator=(Scope &&) = delete;
+        ~Scope();
+    };
+
+    PhaseProfile() = default;
+    PhaseProfile(const PhaseProfile &) = delete;
+    PhaseProfile &operator=(const PhaseProfile &) = delete;
+    // Keeps the timer group from printing a report of its own.
+    ~PhaseProfile();
+
+    // Phases measured repeatedly add up.
+    [[nodiscard]] Scope measure(llvm::StringRef phase);
+    void count(llvm::StringRef counter, std::uint64_t value);
+
+    void print(llvm::raw_ostream &stream) const;
+    void print_json(llvm::raw_ostream &stream) const;
+};
+
+#endif
@@ -0,0 +1,191 @@
+#ifndef CHARACTERCLASS_HPP
+#define CHARACTERCLASS_HPP
+
+#include <array>
+#include <bit>
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+enum class CharacterClass : std::uint8_t {
+    invalid,
+    space,
+    digit,
+    letter,
+    operator_symbol,
+    assignment,
+    left_parenthesis,
+    right_parenthesis,
+    comment_start,
+};
+
+constexpr std::array<CharacterClass, 256> character_classes = [] {
+    using enum CharacterClass;
+    std::array<CharacterClass, 256> classes{};
+    for (auto c : {' ', '\t', '\n', '\v', '\f', '\r'}) {
+        classes[static_cast<unsigned char>(c)] = space;
+    }
+    for (auto c = '0'; c <= '9'; ++c) {
+        classes[static_cast<unsigned char>(c)] = digit;
+    }
+    for (auto c = 'a'; c <= 'z'; ++c) {
+        classes[static_cast<unsigned char>(c)] = letter;
+        classes[static_cast<unsigned char>(c - 'a' + 'A')] = letter;
+    }
+    classes['_'] = letter;
+    for (auto c : {'+', '-', '*', '/', '%'}) {
+        classes[static_cast<unsigned char>(c)] = operator_symbol;
+    }
+    classes['='] = assignment;
+    classes['('] = left_parenthesis;
+    classes[')'] = right_parenthesis;
+    classes['{'] = comment_start;
+    return classes;
+}();
+
+constexpr CharacterClass classify(const char c) {
+    return character_classes[static_cast<unsigned char>(c)];
+}
+
+#if defined(__SSE2__)
+struct SSE2 {
+    using Vector = __m128i;
+    static constexpr std::size_t width = 16;
+
+    static Vector load(const char *characters) {
+        return _mm_loadu_si128(reinterpret_cast<const Vector *>(characters));
+    }
+    static Vector equal(Vector characters, char c) {
+        return _mm_cmpeq_epi8(characters, _mm_set1_epi8(c));
+    }
+    // Only valid for ASCII bounds. Non-ASCII characters are negative and thus never in range.
+    static Vector in_range(Vector characters, char lower, char upper) {
+        return _mm_and_si128(_mm_cmpgt_epi8(characters, _mm_set1_epi8(static_cast<char>(lower - 1))),
+                             _mm_cmplt_epi8(characters, _mm_set1_epi8(static_cast<char>(upper + 1))));
+    }
+    static Vector either(Vector left, Vector right) {
+        return _mm_or_si128(left, right);
+    }
+    static std::uint32_t mask(Vector matches) {
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(matches));
+    }
+};
+#endif
+
+#if defined(__AVX2__)
+struct AVX2 {
+    using Vector = __m256i;
+    static constexpr std::size_t width = 32;
+
+    static Vector load(const char *characters) {
+        return _mm256_loadu_si256(reinterpret_cast<const Vector *>(characters));
+    }
+    static Vector equal(Vector characters, char c) {
+        return _mm256_cmpeq_epi8(characters, _mm256_set1_epi8(c));
+    }
+    static Vector in_range(Vector characters, char lower, char upper) {
+        return _mm256_and_si256(_mm256_cmpgt_epi8(characters, _mm256_set1_epi8(static_cast<char>(lower - 1))),
+                                _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(upper + 1)), characters));
+    }
+    static Vector either(Vector left, Vector right) {
+        return _mm256_or_si256(left, right);
+    }
+    static std::uint32_t mask(Vector matches) {
+        return static_cast<std::uint32_t>(_mm256_movemask_epi8(matches));
+    }
+};
+#endif
+
+struct SpaceMatcher {
+    bool operator()(const char c) const {
+        return classify(c) == CharacterClass::space;
+    }
+    template <class ISA>
+    static typename ISA::Vector match(typename ISA::Vector characters) {
+        return ISA::either(ISA::equal(characters, ' '), ISA::in_range(characters, '\t', '\r'));
+    }
+};
+
+struct DigitMatcher {
+    bool operator()(const char c) const {
+        return classify(c) == CharacterClass::digit;
+    }
+    template <class ISA>
+    static typename ISA::Vector match(typename ISA::Vector characters) {
+        return ISA::in_range(characters, '0', '9');
+    }
+};
+
+struct IdentifierMatcher {
+    bool operator()(const char c) const {
+        auto character_class = classify(c);
+        return character_class == CharacterClass::letter || character_class == CharacterClass::digit;
+    }
+    template <class ISA>
+    static typename ISA::Vector match(typename ISA::Vector characters) {
+        return ISA::either(ISA::either(ISA::in_range(characters, 'a', 'z'), ISA::in_range(characters, 'A', 'Z')),
+                           ISA::either(ISA::in_range(characters, '0', '9'), ISA::equal(characters, '_')));
+    }
+};
+
+struct OperatorMatcher {
+    bool operator()(const char c) const {
+        return classify(c) == CharacterClass::operator_symbol;
+    }
+};
+
+struct CommentMatcher {
+    // The vectorized variant searches for the end of the comment, so its matches have to be inverted.
+    static constexpr bool inverted = true;
+
+    bool operator()(const char c) const {
+        return c != '}';
+    }
+    template <class ISA>
+    static typename ISA::Vector match(typename ISA::Vector characters) {
+        return ISA::equal(characters, '}');
+    }
+};
+
+#if defined(__SSE2__)
+template <class ISA, class Matcher>
+const char *scan_vectors_while(const char *current, const char *end) {
+    constexpr auto all_matching = ISA::width == 32 ? ~std::uint32_t{0} : (std::uint32_t{1} << ISA::width) - 1;
+    while (static_cast<std::size_t>(end - current) >= ISA::width) {
+        auto matches = ISA::mask(Matcher::template match<ISA>(ISA::load(current)));
+        if constexpr (requires { Matcher::inverted; }) {
+            matches = ~matches & all_matching;
+        }
+        if (matches != all_matching) {
+            return current + std::countr_one(matches);
+        }
+        current += ISA::width;
+    }
+    return current;
+}
+#endif
+
+// Returns the first character in [current, end) not accepted by the matcher. If the matcher supports it, runs are
+// scanned a whole vector at a time using AVX2 or SSE2, depending on the target. The rest is classified one by one.
+template <class Matcher>
+const char *scan_while(const char *current, const char *end, const Matcher &matcher) {
+#if defined(__SSE2__)
+    if constexpr (requires(SSE2::Vector characters) { Matcher::template match<SSE2>(characters); }) {
+#if defined(__AVX2__)
+        current = scan_vectors_while<AVX2, Matcher>(current, end);
+        if (current != end && !matcher(*current)) {
+            return current;
+        }
+#endif
+        current = scan_vectors_while<SSE2, Matcher>(current, end);
+    }
+#endif
+    while (current != end && matcher(*current)) {
+        ++current;
+    }
+    return current;
+}
+
+#endif
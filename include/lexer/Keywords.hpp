@@ -0,0 +1,51 @@
+#ifndef KEYWORDS_HPP
+#define KEYWORDS_HPP
+
+#include "lexer/TokenType.hpp"
+
+#include <array>
+#include <string_view>
+
+struct Keyword {
+    std::string_view name;
+    TokenType type = TokenType::variable_t;
+};
+
+// The sum of the first and the last character separates all keywords without collisions. Building the table fails at
+// compile time otherwise.
+constexpr std::size_t keyword_hash(const std::string_view name) {
+    return static_cast<std::size_t>(name.front() + name.back()) % 32;
+}
+
+constexpr std::array<Keyword, 32> keyword_table = [] {
+    using enum TokenType;
+    std::array<Keyword, 32> table{};
+    for (auto keyword : {Keyword{"BEGIN", begin_t},
+                         Keyword{"END", end_t},
+                         Keyword{"LOOP", loop_t},
+                         Keyword{"BREAK", break_t},
+                         Keyword{"IFN", ifn_t},
+                         Keyword{"IFP", ifp_t},
+                         Keyword{"IFZ", ifz_t},
+                         Keyword{"ELSE", else_t},
+                         Keyword{"PRINT", print_t},
+                         Keyword{"READ", read_t}}) {
+        auto &entry = table[keyword_hash(keyword.name)];
+        if (!entry.name.empty()) {
+            throw "Keyword hash collision.";
+        }
+        entry = keyword;
+    }
+    return table;
+}();
+
+// Returns the keyword's token type or 'TokenType::variable_t' if the identifier is not a keyword.
+constexpr TokenType classify_identifier(const std::string_view identifier) {
+    if (identifier.size() < 3 || identifier.size() > 5) {
+        return TokenType::variable_t;
+    }
+    const auto &entry = keyword_table[keyword_hash(identifier)];
+    return entry.name == identifier ? entry.type : TokenType::variable_t;
+}
+
+#endif
@@ -1,13 +1,19 @@
 #ifndef LEXER_HPP
 #define LEXER_HPP
 
+#include "lexer/CharacterClass.hpp"
+#include "lexer/Keywords.hpp"
+#include "lexer/SymbolTable.hpp"
 #include "lexer/Token.hpp"
 
-#include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/StringSaver.h"
 
 #include <iterator>
+#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <type_traits>
 
 template <class I>
@@ -29,7 +35,15 @@ class Lexer {
 
     std::optional<Token> current_token;
 
+    SymbolTable *symbols = nullptr;
+
+    // Tokens of contiguous inputs refer to the input directly. All other inputs need their token values to be stored
+    // somewhere. This storage is shared by all copies of the lexer.
+    std::shared_ptr<llvm::BumpPtrAllocator> token_storage;
+
   public:
+    Lexer(InputIterator begin, InputIterator end, SymbolTable &symbols);
+    // Does not intern variable names. All variables get the same symbol.
     Lexer(InputIterator begin, InputIterator end);
     Lexer() = default;
 
@@ -40,19 +54,34 @@ class Lexer {
     bool operator!=(const Lexer &other) const;
 
   private:
+    Lexer(InputIterator begin, InputIterator end, SymbolTable *symbols);
+
     std::optional<Token> next();
     template <class TokenMatcher>
         requires std::is_invocable_r_v<bool, TokenMatcher, char>
-    std::string get_while_matching(const TokenMatcher &matcher);
-
-    static bool is_operator(char c);
-    static bool is_identifier(char c);
+    std::string_view get_while_matching(const TokenMatcher &matcher);
+    std::string_view get_single_character();
+    template <class TokenMatcher>
+        requires std::is_invocable_r_v<bool, TokenMatcher, char>
+    void skip_while_matching(const TokenMatcher &matcher);
 };
 
+template <CharIterator InputIterator>
+Lexer<InputIterator>::Lexer(InputIterator begin, InputIterator end, SymbolTable &symbols)
+  : Lexer(begin, end, &symbols) {}
+
 template <CharIterator InputIterator>
 Lexer<InputIterator>::Lexer(InputIterator begin, InputIterator end)
+  : Lexer(begin, end, nullptr) {}
+
+template <CharIterator InputIterator>
+Lexer<InputIterator>::Lexer(InputIterator begin, InputIterator end, SymbolTable *symbols)
   : current_character(begin)
-  , characters_end(end) {
+  , characters_end(end)
+  , symbols(symbols) {
+    if constexpr (!std::contiguous_iterator<InputIterator>) {
+        token_storage = std::make_shared<llvm::BumpPtrAllocator>();
+    }
     if (current_character != characters_end) {
         ++(*this);
     }
@@ -88,37 +117,37 @@ bool Lexer<InputIterator>::operator!=(const Lexer &other) const {
 template <CharIterator InputIterator>
 std::optional<Token> Lexer<InputIterator>::next() {
     while (current_character != characters_end) {
-        if (isspace(*current_character) != 0) {
-            ++current_character;
-        } else if (isdigit(*current_character) != 0) {
-            return Token(TokenType::number_t, get_while_matching(isdigit));
-        } else if (is_operator(*current_character)) {
-            return Token(TokenType::operator_t, get_while_matching(is_operator));
-        } else if (*current_character == '=') {
-            return Token(TokenType::assignment_t, *current_character++);
-        } else if (*current_character == '(') {
-            return Token(TokenType::left_parenthesis_t, *current_character++);
-        } else if (*current_character == ')') {
-            return Token(TokenType::right_parenthesis_t, *current_character++);
-        } else if (is_identifier(*current_character)) {
-            auto token = get_while_matching(is_identifier);
-            auto token_type = llvm::StringSwitch<TokenType>(token)
-                                  .Case("BEGIN", TokenType::begin_t)
-                                  .Case("END", TokenType::end_t)
-                                  .Case("LOOP", TokenType::loop_t)
-                                  .Case("BREAK", TokenType::break_t)
-                                  .Case("IFN", TokenType::ifn_t)
-                                  .Case("IFP", TokenType::ifp_t)
-                                  .Case("IFZ", TokenType::ifz_t)
-                                  .Case("ELSE", TokenType::else_t)
-                                  .Case("PRINT", TokenType::print_t)
-                                  .Case("READ", TokenType::read_t)
-                                  .Default(TokenType::variable_t);
-            return Token(token_type, token);
-        } else if (*current_character == '{') {
-            current_character = std::next(std::find(current_character, characters_end, '}'));
-        } else {
-            throw std::logic_error("Cannot handle the current character.");
+        switch (classify(*current_character)) {
+            using enum CharacterClass;
+            case space:
+                skip_while_matching(SpaceMatcher());
+                break;
+            case digit:
+                return Token(TokenType::number_t, get_while_matching(DigitMatcher()));
+            case operator_symbol:
+                return Token(TokenType::operator_t, get_while_matching(OperatorMatcher()));
+            case assignment:
+                return Token(TokenType::assignment_t, get_single_character());
+            case left_parenthesis:
+                return Token(TokenType::left_parenthesis_t, get_single_character());
+            case right_parenthesis:
+                return Token(TokenType::right_parenthesis_t, get_single_character());
+            case letter: {
+                auto identifier = get_while_matching(IdentifierMatcher());
+                auto token_type = classify_identifier(identifier);
+                if (token_type == TokenType::variable_t) {
+                    return Token(token_type, identifier, symbols ? symbols->intern(identifier) : 0);
+                }
+                return Token(token_type, identifier);
+            }
+            case comment_start:
+                skip_while_matching(CommentMatcher());
+                if (current_character != characters_end) {
+                    ++current_character;
+                }
+                break;
+            case invalid:
+                throw std::logic_error("Cannot handle the current character.");
         }
     }
     return {};
@@ -127,22 +156,40 @@ std::optional<Token> Lexer<InputIterator>::next() {
 template <CharIterator InputIterator>
 template <class TokenMatcher>
     requires std::is_invocable_r_v<bool, TokenMatcher, char>
-std::string Lexer<InputIterator>::get_while_matching(const TokenMatcher &matcher) {
-    std::string value;
-    do {
-        value += *current_character++;
-    } while (current_character != characters_end && matcher(*current_character));
-    return value;
+std::string_view Lexer<InputIterator>::get_while_matching(const TokenMatcher &matcher) {
+    if constexpr (std::contiguous_iterator<InputIterator>) {
+        auto first_character = current_character++;
+        skip_while_matching(matcher);
+        return {std::to_address(first_character), static_cast<std::size_t>(current_character - first_character)};
+    } else {
+        std::string value;
+        do {
+            value += *current_character++;
+        } while (current_character != characters_end && matcher(*current_character));
+        return llvm::StringSaver(*token_storage).save(value);
+    }
 }
 
 template <CharIterator InputIterator>
-bool Lexer<InputIterator>::is_operator(const char c) {
-    return c == '+' || c == '-' || c == '*' || c == '/' || c == '%';
+std::string_view Lexer<InputIterator>::get_single_character() {
+    return get_while_matching([](char /*c*/) {
+        return false;
+    });
 }
 
 template <CharIterator InputIterator>
-bool Lexer<InputIterator>::is_identifier(const char c) {
-    return (isalnum(c) != 0) || c == '_';
+template <class TokenMatcher>
+    requires std::is_invocable_r_v<bool, TokenMatcher, char>
+void Lexer<InputIterator>::skip_while_matching(const TokenMatcher &matcher) {
+    if constexpr (std::contiguous_iterator<InputIterator>) {
+        const auto *first_character = std::to_address(current_character);
+        const auto *last_character = first_character + (characters_end - current_character);
+        current_character += scan_while(first_character, last_character, matcher) - first_character;
+    } else {
+        while (current_character != characters_end && matcher(*current_character)) {
+            ++current_character;
+        }
+    }
 }
 
 #endif
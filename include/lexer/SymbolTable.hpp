@@ -0,0 +1,29 @@
+#ifndef SYMBOLTABLE_HPP
+#define SYMBOLTABLE_HPP
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <cstdint>
+#include <vector>
+
+using SymbolID = std::uint32_t;
+
+// Maps every distinct variable name to a dense ID starting at 0. Later stages index flat vectors by these IDs instead
+// of hashing names again.
+class SymbolTable {
+    llvm::StringMap<SymbolID> ids;
+    std::vector<llvm::StringRef> names;
+
+  public:
+    SymbolID intern(llvm::StringRef name);
+
+    [[nodiscard]] llvm::StringRef get_name(const SymbolID id) const {
+        return names[id];
+    }
+    [[nodiscard]] std::size_t size() const {
+        return names.size();
+    }
+};
+
+#endif
@@ -1,19 +1,20 @@
 #ifndef TOKEN_HPP
 #define TOKEN_HPP
 
+#include "lexer/SymbolTable.hpp"
 #include "lexer/TokenType.hpp"
 
-#include <string>
+#include <string_view>
 
 struct Token {
     TokenType type;
-    std::string value;
+    std::string_view value;
+    SymbolID symbol; // Only meaningful for variables.
 
-    Token(TokenType type, std::string value)
+    Token(TokenType type, std::string_view value, SymbolID symbol = 0)
       : type(type)
-      , value(std::move(value)) {}
-    Token(TokenType type, char value)
-      : Token(type, std::string(1, value)) {}
+      , value(value)
+      , symbol(symbol) {}
 };
 
 #endif
@@ -0,0 +1,50 @@
+#ifndef COMPILEDPROGRAM_HPP
+#define COMPILEDPROGRAM_HPP
+
+#include "execution/ModuleProcessor.hpp"
+#include "runtime/Runtime.hpp"
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Passes/OptimizationLevel.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+
+// Without an optimization level, not even the AST is optimized.
+struct CompileOptions {
+    std::optional<llvm::OptimizationLevel> optimization_level = llvm::OptimizationLevel::O2;
+    TargetDescription target;
+};
+
+// A Bitsy program compiled to native code once, which the embedding process can then run any number of times, e.g.
+//
+//     CompiledProgram program{"BEGIN READ n PRINT n * n END"};
+//     std::string output;
+//     program.run("7", output); // The output is "49\n".
+//
+// Runs share no state, so they may happen on several threads at once. Instead of the standard streams, a run reads its
+// input from and writes its output to the ones it is given. Costs beyond the native code are those of the callbacks.
+class CompiledProgram {
+    std::unique_ptr<llvm::orc::LLLazyJIT> jit;
+    int (*main_function)() = nullptr;
+
+  public:
+    // Throws 'std::logic_error' if the source is no valid program or cannot be compiled.
+    explicit CompiledProgram(llvm::StringRef source, const CompileOptions &options = {});
+    CompiledProgram(CompiledProgram &&) noexcept;
+    CompiledProgram &operator=(CompiledProgram &&) noexcept;
+    ~CompiledProgram();
+
+    // Runs the program and returns its exit status. A run dividing by zero or the smallest number by -1 ends right there
+    // with 'bitsy_division_error' instead of trapping. The reader returns the next chunk of input, which must stay valid
+    // until it is called again, and an empty chunk at the end. The writer gets the output chunk by chunk. Neither of
+    // them may throw.
+    int run(llvm::function_ref<llvm::StringRef()> read, llvm::function_ref<void(llvm::StringRef)> write) const;
+    // Appends the output to the given string.
+    int run(llvm::StringRef input, std::string &output) const;
+    int run(const BitsyIO &io) const;
+};
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef CONCURRENTTOKENSOURCE_HPP
+#define CONCURRENTTOKENSOURCE_HPP
+
+#include "parser/TokenStream.hpp"
+
+#include <memory>
+
+// Runs another token source on a producer thread ahead of its consumer. Tokens are handed over in batches through a
+// bounded single-producer single-consumer queue, so memory usage does not depend on the length of the input. Errors of
+// the wrapped source are rethrown on the consuming side once all tokens before them have been consumed.
+class ConcurrentTokenSource {
+    class Queue;
+
+    std::shared_ptr<Queue> queue;
+
+  public:
+    explicit ConcurrentTokenSource(TokenStream::TokenSource source);
+
+    std::optional<Token> operator()();
+};
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef PARALLELPARSER_HPP
+#define PARALLELPARSER_HPP
+
+#include "ast/ASTContext.hpp"
+#include "ast/Statement.hpp"
+#include "lexer/SymbolTable.hpp"
+#include "lexer/Token.hpp"
+
+#include "llvm/Support/ThreadPool.h"
+
+#include <optional>
+#include <vector>
+
+// Lexes and parses the top-level statements of a program on multiple threads. A pre-scan lexes chunks of the input
+// concurrently without interning names and keeps only the tokens relevant for the structure of the program. Tracking
+// the nesting of blocks over these tokens gives the starts of the top-level statements. The top-level block is split
+// there into ranges of similar size. Every range is parsed on its own with a separate symbol table. Afterwards, the
+// symbol tables are merged in order of the ranges and the ranges are stitched together.
+//
+// The result is identical to the one of a sequential 'Parser', including the IDs of all symbols. If the pre-scan or
+// any range fails, the whole program is parsed sequentially again to report the same error.
+class ParallelParser {
+    const char *characters_begin;
+    const char *characters_end;
+    SymbolTable &symbols;
+    ASTContext &context;
+    unsigned int thread_count;
+
+  public:
+    ParallelParser(const char *begin, const char *end, SymbolTable &symbols, ASTContext &context, unsigned int threads);
+    Program *parse();
+
+  private:
+    // The tokens of a chunk that open, close or start statements. Assignments are represented by their variable.
+    struct ScannedChunk {
+        std::vector<Token> tokens;
+        std::optional<TokenType> first_token_type;
+        bool starts_with_assignment = false;
+        const char *trailing_variable = nullptr;
+        bool valid = true;
+    };
+
+    struct Range {
+        const char *begin;
+        const char *end;
+        ASTContext *context;
+        SymbolTable symbols;
+        Block *block = nullptr;
+    };
+
+    [[nodiscard]] std::vector<const char *> scan_statement_starts(llvm::ThreadPool &pool) const;
+    [[nodiscard]] std::vector<const char *> split_into_chunks() const;
+    static ScannedChunk scan_chunk(const char *begin, const char *end);
+    [[nodiscard]] std::vector<Range> split(const std::vector<const char *> &statement_starts) const;
+    static void parse_range(Range &range);
+    static void relabel_symbols(Block *block, const std::vector<SymbolID> &new_symbols);
+    Program *parse_sequentially();
+};
+
+#endif
@@ -1,28 +1,37 @@
 #ifndef PARSER_HPP
 #define PARSER_HPP
 
+#include "ast/ASTContext.hpp"
 #include "ast/Statement.hpp"
-#include "lexer/Token.hpp"
+#include "parser/TokenStream.hpp"
 
-#include <memory>
-#include <vector>
+#include <cstddef>
 
 class Parser {
-    std::vector<Token>::iterator token;
+    // A block whose statements are still being parsed. Nested blocks are tracked on an explicit stack of these instead
+    // of the call stack, so the nesting depth of a program is only limited by memory.
+    struct OpenBlock {
+        enum class Owner { program, loop_statement, then_block, else_block };
+
+        Owner owner;
+        std::size_t first_statement;
+        IfStatementType if_statement_type = IfStatementType::zero;
+        Expression *condition = nullptr;
+        Block *then_block = nullptr;
+    };
+
+    TokenStream token;
+    ASTContext &context;
 
   public:
-    explicit Parser(std::vector<Token> &tokens);
-    std::unique_ptr<Program> parse();
+    // All nodes of the parsed program are allocated in the given context, which thus has to outlive the program.
+    Parser(TokenStream tokens, ASTContext &context);
+    Program *parse();
 
   private:
-    const Token *advance();
-    std::unique_ptr<Expression> parse_expression();
-    std::unique_ptr<Expression> parse_single_expression_component();
-    std::unique_ptr<Expression> parse_parenthesis_expression();
-    std::unique_ptr<Expression> parse_binary_expression(int precedence, std::unique_ptr<Expression> left_expression);
-    std::unique_ptr<Block> parse_block(TokenType additional_stop_token = TokenType::end_t);
-    std::unique_ptr<Statement> parse_statement();
-    std::unique_ptr<Statement> parse_if_statement(IfStatementType type);
+    Expression *parse_expression();
+    Expression *parse_operand();
+    Statement *parse_simple_statement();
 };
 
 #endif
@@ -0,0 +1,68 @@
+#ifndef TOKENSTREAM_HPP
+#define TOKENSTREAM_HPP
+
+#include "lexer/Token.hpp"
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <optional>
+
+class TokenStream {
+
+  public:
+    // Yields the next token or nothing at the end of the input.
+    using TokenSource = std::function<std::optional<Token>()>;
+
+    static constexpr std::size_t lookahead = 4;
+
+  private:
+    TokenSource source;
+
+    std::array<std::optional<Token>, lookahead> buffer;
+    std::size_t position = 0;
+    std::size_t fetched = 0;
+
+  public:
+    explicit TokenStream(TokenSource source)
+      : source(std::move(source)) {}
+    template <class TokenIterator>
+    TokenStream(TokenIterator begin, TokenIterator end)
+      : TokenStream(make_source(begin, end)) {}
+
+    template <class TokenIterator>
+    static TokenSource make_source(TokenIterator begin, TokenIterator end);
+
+    // The tokens at or after the current one. Only 'lookahead' tokens are buffered at any time, thus 'offset' must be
+    // less than that. Throws if the input ends too early.
+    const Token &peek(std::size_t offset = 1);
+    [[nodiscard]] bool exhausted();
+
+    const Token &operator*() {
+        return peek(0);
+    }
+    const Token *operator->() {
+        return &peek(0);
+    }
+    TokenStream &operator++() {
+        ++position;
+        return *this;
+    }
+
+  private:
+    bool fetch(std::size_t offset);
+};
+
+template <class TokenIterator>
+TokenStream::TokenSource TokenStream::make_source(TokenIterator begin, TokenIterator end) {
+    return [begin, end]() mutable -> std::optional<Token> {
+        if (begin == end) {
+            return {};
+        }
+        Token token = *begin;
+        ++begin;
+        return token;
+    };
+}
+
+#endif
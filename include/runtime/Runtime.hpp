@@ -0,0 +1,39 @@
+#ifndef RUNTIME_HPP
+#define RUNTIME_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Functions called by compiled Bitsy programs. They are linked into 'bitsyc' for the JIT compiler and the interpreter,
+// and into every executable built with '-c'.
+extern "C" {
+
+// Appends the number and a newline to the output buffer of the calling thread.
+void bitsy_print_i32(std::int32_t value);
+
+// Reads the next integer from the standard input like 'scanf("%i")' does and returns it. If there is none, the given
+// current value of the variable is returned. Buffered output is written first, so prompts appear before waiting.
+std::int32_t bitsy_read_i32(std::int32_t current);
+
+// Writes the buffered output of the calling thread. Programs do so before reading input and before they end.
+void bitsy_flush();
+
+// Input and output of the programs run by a thread in place of the standard streams. 'read' returns the next chunk of
+// input, which must stay valid until the next call, and 0 at the end of the input. 'write' takes buffered output.
+struct BitsyIO {
+    void *context;
+    std::size_t (*read)(void *context, const char **chunk);
+    void (*write)(void *context, const char *data, std::size_t size);
+};
+
+// Routes the input and output of the calling thread to the given I/O, or back to the standard streams for 'nullptr'.
+// Buffered output is written to the previous destination first, while unread input of the previous I/O is dropped.
+// Returns the previous I/O.
+const BitsyIO *bitsy_set_io(const BitsyIO *io);
+
+// Exit status of programs with checked divisions that divide by zero or the smallest number by -1, the one a shell
+// reports for a process killed by 'SIGFPE'.
+constexpr std::int32_t bitsy_division_error = 136;
+}
+
+#endif
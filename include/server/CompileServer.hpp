@@ -0,0 +1,37 @@
+#ifndef COMPILESERVER_HPP
+#define COMPILESERVER_HPP
+
+#include "llvm/Support/raw_ostream.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// Serves the requests of 'bitsyc-client' on a Unix domain socket. The server pays for loading the compiler, parsing
+// the options and initializing the targets only once. Every request runs in a process forked from the server, so it
+// starts in that warm state but with the client's standard streams and working directory. A request thus can neither
+// disturb the server nor other requests, whatever its program does. It is killed if the client disconnects early.
+class CompileServer {
+    std::string socket_path;
+    int listening_socket = -1;
+
+  public:
+    // Handles the command line of a request and returns its exit status. It runs in the forked process.
+    using Handler = std::function<int(const std::vector<std::string> &arguments)>;
+
+    explicit CompileServer(std::string socket_path);
+    CompileServer(const CompileServer &) = delete;
+    CompileServer &operator=(const CompileServer &) = delete;
+    ~CompileServer();
+
+    // Fails if the socket cannot be created or another server is listening on it already.
+    [[nodiscard]] bool listen(llvm::raw_ostream &diagnostics = llvm::errs());
+    // Accepts requests until the server is terminated.
+    void serve(const Handler &handler) const;
+
+    [[nodiscard]] const std::string &get_socket_path() const {
+        return socket_path;
+    }
+};
+
+#endif
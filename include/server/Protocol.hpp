@@ -0,0 +1,38 @@
+#ifndef PROTOCOL_HPP
+#define PROTOCOL_HPP
+
+#include <array>
+#include <optional>
+#include <string>
+#include <vector>
+
+// A request to the compile server is the command line of a bitsyc call together with the working directory of the
+// client. The client's standard input, output and error go along as file descriptors, so the program reads and writes
+// them directly. The server answers with the exit status once the request is done.
+//
+// The protocol is meant for a client and a server on the same host and thus uses its byte order. It must not depend
+// on LLVM, as the client would have to load it otherwise.
+struct Request {
+    std::string working_directory;
+    std::vector<std::string> arguments;
+    std::array<int, 3> standard_streams{-1, -1, -1};
+};
+
+// The path in 'BITSYC_SOCKET' or one in a directory private to the user, which is '$XDG_RUNTIME_DIR' or
+// '/tmp/bitsyc-<uid>'.
+std::string get_default_socket_path();
+
+// Whether the process on the other end of the connection runs as the same user as this one. Nobody else may send
+// requests to the server or receive the standard streams of a client.
+bool is_same_user(int socket);
+
+// Returns the connected socket or -1, also if the server runs as another user.
+int connect_to_server(const std::string &socket_path);
+
+bool send_request(int socket, const Request &request);
+std::optional<Request> receive_request(int socket);
+
+bool send_status(int socket, int status);
+std::optional<int> receive_status(int socket);
+
+#endif
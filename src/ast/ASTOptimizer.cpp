@@ -0,0 +1,225 @@
+#include "ast/ASTOptimizer.hpp"
+
+#include "ast/ASTVisitor.hpp"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Casting.h"
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+std::optional<std::int32_t> evaluate(const char operator_symbol, const std::int32_t lhs, const std::int32_t rhs) {
+    // Overflows wrap around like in the generated code. Divisions trapping at runtime are left to the runtime.
+    const auto wrap = [](const std::uint32_t value) {
+        return static_cast<std::int32_t>(value);
+    };
+    const auto unsigned_lhs = static_cast<std::uint32_t>(lhs);
+    const auto unsigned_rhs = static_cast<std::uint32_t>(rhs);
+    switch (operator_symbol) {
+        case '+':
+            return wrap(unsigned_lhs + unsigned_rhs);
+        case '-':
+            return wrap(unsigned_lhs - unsigned_rhs);
+        case '*':
+            return wrap(unsigned_lhs * unsigned_rhs);
+        case '/':
+        case '%':
+            if (rhs == 0 || (lhs == std::numeric_limits<std::int32_t>::min() && rhs == -1)) {
+                return std::nullopt;
+            }
+            return operator_symbol == '/' ? lhs / rhs : lhs % rhs;
+        default:
+            throw std::logic_error("Unknown binary operator.");
+    }
+}
+
+bool is_satisfied(const IfStatementType type, const std::int32_t value) {
+    switch (type) {
+        case IfStatementType::zero:
+            return value == 0;
+        case IfStatementType::positive:
+            return value > 0;
+        case IfStatementType::negative:
+            return value < 0;
+    }
+    throw std::logic_error("Unknown 'IfStatement' type.");
+}
+
+// The expressions folded in place, as a node family for 'visit_post_order'. Leaves are passed on as expressions.
+struct MutableExpressions {
+    using Expression = ::Expression *;
+    using BinaryOperationExpression = ::BinaryOperationExpression *;
+
+    template <class Visitor>
+    static void dispatch(Expression expression, Visitor &&visitor) {
+        if (auto *operation = llvm::dyn_cast<::BinaryOperationExpression>(expression)) {
+            visitor(operation);
+        } else {
+            visitor(expression);
+        }
+    }
+};
+
+// Calls the function for the block and all blocks nested in it. A block is passed to the function before the blocks
+// nested in its statements are looked up, so the function may replace the statements.
+template <class Function>
+void for_each_block(Block *block, Function &&function) {
+    std::vector<Block *> pending_blocks{block};
+    while (!pending_blocks.empty()) {
+        auto *next_block = pending_blocks.back();
+        pending_blocks.pop_back();
+        function(next_block);
+        for (auto *statement : next_block->statements) {
+            if (auto *if_statement = llvm::dyn_cast<IfStatement>(statement)) {
+                if (if_statement->else_block) {
+                    pending_blocks.push_back(if_statement->else_block);
+                }
+                pending_blocks.push_back(if_statement->then_block);
+            } else if (auto *loop_statement = llvm::dyn_cast<LoopStatement>(statement)) {
+                pending_blocks.push_back(loop_statement->block);
+            }
+        }
+    }
+}
+
+template <class Function>
+void for_each_variable(Expression *expression, Function &&function) {
+    llvm::SmallVector<Expression *, 16> pending_expressions{expression};
+    while (!pending_expressions.empty()) {
+        auto *next_expression = pending_expressions.pop_back_val();
+        if (auto *operation = llvm::dyn_cast<BinaryOperationExpression>(next_expression)) {
+            pending_expressions.append({operation->right_expression, operation->left_expression});
+        } else if (auto *variable = llvm::dyn_cast<VariableExpression>(next_expression)) {
+            function(variable->symbol);
+        }
+    }
+}
+
+} // namespace
+
+void ASTOptimizer::optimize(Program *program) {
+    simplify(program->block);
+    remove_dead_assignments(program->block);
+}
+
+void ASTOptimizer::simplify(Block *block) {
+    llvm::SmallVector<Statement *, 64> statements;
+    // Statements of the block still to be simplified. Branches of constant conditions are spliced into the block by
+    // continuing with their statements before the remaining ones.
+    llvm::SmallVector<llvm::ArrayRef<Statement *>, 8> pending_statements;
+    for_each_block(block, [&](Block *current_block) {
+        statements.clear();
+        pending_statements.assign(1, current_block->statements);
+        while (!pending_statements.empty()) {
+            if (pending_statements.back().empty()) {
+                pending_statements.pop_back();
+                continue;
+            }
+            auto *statement = pending_statements.back().front();
+            pending_statements.back() = pending_statements.back().drop_front();
+            if (auto *if_statement = llvm::dyn_cast<IfStatement>(statement)) {
+                if_statement->expression = fold(if_statement->expression);
+                if (auto *condition = llvm::dyn_cast<NumberExpression>(if_statement->expression)) {
+                    auto *taken_block = is_satisfied(if_statement->type, condition->value) ? if_statement->then_block
+                                                                                            : if_statement->else_block;
+                    if (taken_block) {
+                        pending_statements.push_back(taken_block->statements);
+                    }
+                    continue;
+                }
+            } else if (auto *print_statement = llvm::dyn_cast<PrintStatement>(statement)) {
+                print_statement->expression = fold(print_statement->expression);
+            } else if (auto *assignment_statement = llvm::dyn_cast<AssignmentStatement>(statement)) {
+                assignment_statement->expression = fold(assignment_statement->expression);
+            } else if (llvm::isa<BreakStatement>(statement)) {
+                pending_statements.clear();
+            }
+            statements.push_back(statement);
+        }
+        if (llvm::ArrayRef<Statement *>(statements) != current_block->statements) {
+            current_block->statements = context.copy(llvm::ArrayRef<Statement *>(statements));
+        }
+    });
+}
+
+void ASTOptimizer::remove_dead_assignments(Block *block) {
+    llvm::DenseMap<SymbolID, unsigned int> reads;
+    llvm::DenseMap<SymbolID, llvm::SmallVector<AssignmentStatement *, 1>> assignments;
+    const auto count_read = [&](const SymbolID symbol) {
+        ++reads[symbol];
+    };
+    for_each_block(block, [&](Block *current_block) {
+        for (auto *statement : current_block->statements) {
+            if (auto *if_statement = llvm::dyn_cast<IfStatement>(statement)) {
+                for_each_variable(if_statement->expression, count_read);
+            } else if (auto *print_statement = llvm::dyn_cast<PrintStatement>(statement)) {
+                for_each_variable(print_statement->expression, count_read);
+            } else if (auto *assignment_statement = llvm::dyn_cast<AssignmentStatement>(statement)) {
+                for_each_variable(assignment_statement->expression, count_read);
+                assignments[assignment_statement->variable->symbol].push_back(assignment_statement);
+            }
+        }
+    });
+
+    // Removing an assignment drops the reads in its expression, which can leave further variables unread.
+    llvm::SmallVector<SymbolID, 16> unread_variables;
+    for (const auto &[symbol, variable_assignments] : assignments) {
+        if (reads.lookup(symbol) == 0) {
+            unread_variables.push_back(symbol);
+        }
+    }
+    if (unread_variables.empty()) {
+        return;
+    }
+    llvm::DenseSet<const Statement *> dead_statements;
+    while (!unread_variables.empty()) {
+        for (auto *assignment_statement : assignments[unread_variables.pop_back_val()]) {
+            dead_statements.insert(assignment_statement);
+            for_each_variable(assignment_statement->expression, [&](const SymbolID symbol) {
+                if (--reads[symbol] == 0 && assignments.count(symbol) != 0) {
+                    unread_variables.push_back(symbol);
+                }
+            });
+        }
+    }
+
+    llvm::SmallVector<Statement *, 64> statements;
+    for_each_block(block, [&](Block *current_block) {
+        statements.clear();
+        for (auto *statement : current_block->statements) {
+            if (!dead_statements.contains(statement)) {
+                statements.push_back(statement);
+            }
+        }
+        if (statements.size() != current_block->statements.size()) {
+            current_block->statements = context.copy(llvm::ArrayRef<Statement *>(statements));
+        }
+    });
+}
+
+Expression *ASTOptimizer::fold(Expression *expression) {
+    return visit_post_order<MutableExpressions, Expression *>(
+        expression,
+        [](Expression *leaf) {
+            return leaf;
+        },
+        [this](BinaryOperationExpression *operation, Expression *lhs, Expression *rhs, bool) -> Expression * {
+            operation->left_expression = lhs;
+            operation->right_expression = rhs;
+            auto *left_number = llvm::dyn_cast<NumberExpression>(lhs);
+            auto *right_number = llvm::dyn_cast<NumberExpression>(rhs);
+            if (left_number && right_number) {
+                if (auto value = evaluate(operation->operator_symbol, left_number->value, right_number->value)) {
+                    return context.create<NumberExpression>(*value);
+                }
+            }
+            return operation;
+        });
+}
@@ -1,80 +1,95 @@
 #include "ast/ASTPrinter.hpp"
 
+#include "ast/FlatAST.hpp"
 #include "helper/ConsolePrinter.hpp"
 
-void ASTPrinter::visit(const Program *program) {
+template <class Nodes>
+void ASTPrinter<Nodes>::visit(typename Nodes::Program program) {
     cout << "BEGIN" << endl;
     cout << [=, this]() {
-        visit(program->block.get());
+        visit(program->block);
     };
     cout << "END" << endl;
 }
 
-void ASTPrinter::visit(const Block *block) {
-    for (const auto &statement : block->statements) {
-        visit(statement.get());
+template <class Nodes>
+void ASTPrinter<Nodes>::visit(typename Nodes::Block block) {
+    for (auto statement : block->statements) {
+        visit(statement);
     }
 }
 
-void ASTPrinter::visit(const IfStatement *if_statement) {
+template <class Nodes>
+void ASTPrinter<Nodes>::visit(typename Nodes::IfStatement if_statement) {
     cout << "IF" << if_statement->type << " ";
-    ASTVisitor::visit(if_statement->expression.get());
+    visit(if_statement->expression);
     cout << endl;
     cout << [=, this]() {
-        visit(if_statement->then_block.get());
+        visit(if_statement->then_block);
     };
     if (if_statement->else_block) {
         cout << "ELSE" << endl;
         cout << [=, this]() {
-            visit(if_statement->else_block.get());
+            visit(if_statement->else_block);
         };
     }
     cout << "END" << endl;
 }
 
-void ASTPrinter::visit(const LoopStatement *loop_statement) {
+template <class Nodes>
+void ASTPrinter<Nodes>::visit(typename Nodes::LoopStatement loop_statement) {
     cout << "LOOP" << endl;
     cout << [=, this]() {
-        visit(loop_statement->block.get());
+        visit(loop_statement->block);
     };
     cout << "END" << endl;
 }
 
-void ASTPrinter::visit(const PrintStatement *print_statement) {
+template <class Nodes>
+void ASTPrinter<Nodes>::visit(typename Nodes::PrintStatement print_statement) {
     cout << "PRINT ";
-    visit(print_statement->expression.get());
+    visit(print_statement->expression);
     cout << endl;
 }
 
-void ASTPrinter::visit(const ReadStatement *read_statement) {
+template <class Nodes>
+void ASTPrinter<Nodes>::visit(typename Nodes::ReadStatement read_statement) {
     cout << "READ ";
-    visit(read_statement->variable_expression.get());
+    visit(read_statement->variable_expression);
     cout << endl;
 }
 
-void ASTPrinter::visit(const AssignmentStatement *assignment_statement) {
-    visit(assignment_statement->variable.get());
+template <class Nodes>
+void ASTPrinter<Nodes>::visit(typename Nodes::AssignmentStatement assignment_statement) {
+    visit(assignment_statement->variable);
     cout << " = ";
-    visit(assignment_statement->expression.get());
+    visit(assignment_statement->expression);
     cout << endl;
 }
 
-void ASTPrinter::visit(const BreakStatement * /*break_statement*/) {
+template <class Nodes>
+void ASTPrinter<Nodes>::visit(typename Nodes::BreakStatement /*break_statement*/) {
     cout << "BREAK" << endl;
 }
 
-void ASTPrinter::visit(const NumberExpression *number_expression) {
+template <class Nodes>
+void ASTPrinter<Nodes>::visit(typename Nodes::NumberExpression number_expression) {
     cout << number_expression->value;
 }
 
-void ASTPrinter::visit(const VariableExpression *variable_expression) {
-    cout << variable_expression->name;
+template <class Nodes>
+void ASTPrinter<Nodes>::visit(typename Nodes::VariableExpression variable_expression) {
+    cout << symbols.get_name(variable_expression->symbol).str();
 }
 
-void ASTPrinter::visit(const BinaryOperationExpression *binary_operation_expression) {
+template <class Nodes>
+void ASTPrinter<Nodes>::visit(typename Nodes::BinaryOperationExpression binary_operation_expression) {
     cout << "(";
-    visit(binary_operation_expression->left_expression.get());
+    visit(binary_operation_expression->left_expression);
     cout << " " << binary_operation_expression->operator_symbol << " ";
-    visit(binary_operation_expression->right_expression.get());
+    visit(binary_operation_expression->right_expression);
     cout << ")";
 }
+
+template class ASTPrinter<TreeNodes>;
+template class ASTPrinter<FlatAST>;
@@ -0,0 +1,97 @@
+#include "ast/FlatAST.hpp"
+
+#include "llvm/Support/Casting.h"
+
+#include <optional>
+#include <variant>
+
+namespace {
+
+// A node still to be appended or, if 'open_node' is set, a node whose subtree is complete.
+struct PendingNode {
+    std::variant<const Statement *, const Expression *> node;
+    std::optional<NodeIndex> open_node;
+};
+
+} // namespace
+
+FlatAST::FlatAST(const ::Program *program) {
+    // Flattening works on an explicit stack, so deeply nested programs do not exhaust the call stack.
+    std::vector<PendingNode> pending_nodes{{llvm::cast<::Statement>(program), {}}};
+    std::vector<std::variant<const ::Statement *, const ::Expression *>> children;
+    while (!pending_nodes.empty()) {
+        auto [node, open_node] = pending_nodes.back();
+        pending_nodes.pop_back();
+        if (open_node) {
+            subtree_ends[*open_node] = static_cast<NodeIndex>(kinds.size());
+            continue;
+        }
+        children.clear();
+        NodeIndex index;
+        if (const auto *const *statement_pointer = std::get_if<const ::Statement *>(&node)) {
+            const auto *statement = *statement_pointer;
+            if (const auto *program_node = llvm::dyn_cast<::Program>(statement)) {
+                index = append(Kind::program);
+                children.emplace_back(program_node->block);
+            } else if (const auto *block = llvm::dyn_cast<::Block>(statement)) {
+                index = append(Kind::block, static_cast<std::int32_t>(block->statements.size()));
+                children.insert(children.end(), block->statements.begin(), block->statements.end());
+            } else if (const auto *if_statement = llvm::dyn_cast<::IfStatement>(statement)) {
+                index = append(Kind::if_statement, static_cast<std::int32_t>(if_statement->type));
+                children.emplace_back(if_statement->expression);
+                children.emplace_back(if_statement->then_block);
+                if (if_statement->else_block) {
+                    children.emplace_back(if_statement->else_block);
+                }
+            } else if (const auto *loop_statement = llvm::dyn_cast<::LoopStatement>(statement)) {
+                index = append(Kind::loop_statement);
+                children.emplace_back(loop_statement->block);
+            } else if (const auto *print_statement = llvm::dyn_cast<::PrintStatement>(statement)) {
+                index = append(Kind::print_statement);
+                children.emplace_back(print_statement->expression);
+            } else if (const auto *read_statement = llvm::dyn_cast<::ReadStatement>(statement)) {
+                index = append(Kind::read_statement);
+                children.emplace_back(read_statement->variable_expression);
+            } else if (const auto *assignment_statement = llvm::dyn_cast<::AssignmentStatement>(statement)) {
+                index = append(Kind::assignment_statement);
+                children.emplace_back(assignment_statement->variable);
+                children.emplace_back(assignment_statement->expression);
+            } else if (llvm::isa<::BreakStatement>(statement)) {
+                index = append(Kind::break_statement);
+            } else {
+                throw std::logic_error("Unknown 'Statement' type.");
+            }
+        } else {
+            const auto *expression = std::get<const ::Expression *>(node);
+            if (const auto *number_expression = llvm::dyn_cast<::NumberExpression>(expression)) {
+                index = append(Kind::number_expression, number_expression->value);
+            } else if (const auto *variable_expression = llvm::dyn_cast<::VariableExpression>(expression)) {
+                index = append(Kind::variable_expression, static_cast<std::int32_t>(variable_expression->symbol));
+            } else if (const auto *binary_expression = llvm::dyn_cast<::BinaryOperationExpression>(expression)) {
+                index = append(Kind::binary_operation_expression, binary_expression->operator_symbol);
+                children.emplace_back(binary_expression->left_expression);
+                children.emplace_back(binary_expression->right_expression);
+            } else {
+                throw std::logic_error("Unknown 'Expression' type.");
+            }
+        }
+        if (children.empty()) {
+            subtree_ends[index] = index + 1;
+            continue;
+        }
+        pending_nodes.push_back({node, index});
+        for (auto child = children.rbegin(); child != children.rend(); ++child) {
+            pending_nodes.push_back({*child, {}});
+        }
+    }
+    kinds.shrink_to_fit();
+    subtree_ends.shrink_to_fit();
+    payloads.shrink_to_fit();
+}
+
+NodeIndex FlatAST::append(const Kind kind, const std::int32_t payload) {
+    kinds.push_back(kind);
+    subtree_ends.push_back(0);
+    payloads.push_back(payload);
+    return static_cast<NodeIndex>(kinds.size() - 1);
+}
@@ -0,0 +1,35 @@
+#include "helper/BitsycPath.hpp"
+#include "server/Protocol.hpp"
+
+#include <filesystem>
+#include <iostream>
+
+#include <unistd.h>
+
+// Hands its command line over to a server started with 'bitsyc --serve' and exits with the status of the request. The
+// program reads and writes the client's standard streams, so the client can take the place of bitsyc. Without a
+// server, it becomes bitsyc itself.
+int main(int argc, char *argv[]) {
+    auto connection = connect_to_server(get_default_socket_path());
+    if (connection < 0) {
+        argv[0] = const_cast<char *>(BITSYC_PATH);
+        execv(BITSYC_PATH, argv);
+        std::cerr << "Cannot run " << BITSYC_PATH << "." << '\n';
+        return 1;
+    }
+
+    Request request;
+    request.working_directory = std::filesystem::current_path().string();
+    request.arguments.assign(argv, argv + argc);
+    request.standard_streams = {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO};
+    if (!send_request(connection, request)) {
+        std::cerr << "Cannot send the request to the server." << '\n';
+        return 1;
+    }
+    auto status = receive_status(connection);
+    if (!status) {
+        std::cerr << "The server did not answer the request." << '\n';
+        return 1;
+    }
+    return *status;
+}
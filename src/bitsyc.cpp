@@ -1,14 +1,45 @@
+#include "ast/ASTOptimizer.hpp"
 #include "ast/ASTPrinter.hpp"
+#include "ast/FlatAST.hpp"
+#include "codegen/BytecodeGenerator.hpp"
 #include "codegen/ModuleBuilder.hpp"
+#include "execution/BatchCompiler.hpp"
+#include "execution/CompilationCache.hpp"
+#include "execution/InputRunner.hpp"
+#include "execution/Interpreter.hpp"
 #include "execution/ModuleProcessor.hpp"
+#include "execution/TieredExecutor.hpp"
+#include "helper/PhaseProfile.hpp"
 #include "lexer/Lexer.hpp"
+#include "library/CompiledProgram.hpp"
+#include "parser/ConcurrentTokenSource.hpp"
+#include "parser/ParallelParser.hpp"
 #include "parser/Parser.hpp"
+#include "server/CompileServer.hpp"
+#include "server/Protocol.hpp"
 
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "llvm/ExecutionEngine/Orc/ObjectTransformLayer.h"
+#include "llvm/Passes/OptimizationLevel.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
 
-#include <fstream>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
 #include <iostream>
-#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
 
 namespace cl = llvm::cl;
 
@@ -16,49 +47,482 @@ namespace { namespace opt {
 
 cl::OptionCategory category{"Options"};
 
-cl::opt<std::string> input_name{cl::Positional, cl::Required, cl::desc("<bitsy file>"), cl::cat(category)};
+cl::list<std::string> input_names{cl::Positional,
+                                  cl::desc("<bitsy file or directory of .bitsy files> ..."),
+                                  cl::cat(category)};
 cl::opt<std::string> output_name{"o",
                                  cl::desc("Name of the executable output file"),
                                  cl::value_desc("executable"),
                                  cl::init("a.out"),
                                  cl::cat(category)};
 cl::opt<bool> compile{"c", cl::desc("Compile Bitsy file to an exectuable output file"), cl::cat(category)};
+cl::opt<OutputKind> emit{
+    cl::desc("Write the compiled Bitsy file to an unlinked output file instead"),
+    cl::values(clEnumValN(OutputKind::object, "emit-obj", "Emit an object file (default: <input>.o)"),
+               clEnumValN(OutputKind::assembly, "emit-asm", "Emit an assembly file (default: <input>.s)"),
+               clEnumValN(OutputKind::bitcode, "emit-bc", "Emit an LLVM bitcode file (default: <input>.bc)")),
+    cl::init(OutputKind::executable),
+    cl::cat(category)};
+cl::opt<std::string> output_directory{"output-dir",
+                                      cl::desc("Directory of the output files when compiling several inputs or "
+                                               "running the program on '--inputs'"),
+                                      cl::value_desc("directory"),
+                                      cl::init("."),
+                                      cl::cat(category)};
+cl::opt<std::string> inputs{"inputs",
+                            cl::desc("Compile the program once and run it on every file in the directory, printing "
+                                     "the outputs in order or writing them to '--output-dir'"),
+                            cl::value_desc("directory"),
+                            cl::cat(category)};
+cl::opt<unsigned int> jobs{"jobs",
+                           cl::desc("Number of threads compiling several inputs or running the program on "
+                                    "'--inputs' (default: one per core)"),
+                           cl::init(0),
+                           cl::cat(category)};
 cl::opt<bool> quiet{"q", cl::desc("Do not execute the program automatically"), cl::cat(category)};
 cl::opt<bool> no_optimization{"no-opt", cl::desc("Do not run any optimization"), cl::cat(category)};
+enum class OptimizationLevel { O0, O1, O2, O3, Os };
+cl::opt<OptimizationLevel> optimization_level{
+    "O",
+    cl::desc("Optimization level of the generated code (default: -O2)"),
+    cl::values(clEnumValN(OptimizationLevel::O0, "0", "No optimization"),
+               clEnumValN(OptimizationLevel::O1, "1", "Quick optimizations"),
+               clEnumValN(OptimizationLevel::O2, "2", "Most optimizations"),
+               clEnumValN(OptimizationLevel::O3, "3", "All optimizations, including aggressive loop transformations"),
+               clEnumValN(OptimizationLevel::Os, "s", "Optimizations that do not increase the code size")),
+    cl::Prefix,
+    cl::init(OptimizationLevel::O2),
+    cl::cat(category)};
+cl::opt<std::string> cpu{"mcpu",
+                         cl::desc("Processor to generate code for, 'native' being the host (default: native)"),
+                         cl::value_desc("cpu-name"),
+                         cl::init("native"),
+                         cl::cat(category)};
+cl::opt<std::string> features{"mattr",
+                              cl::desc("Processor features to enable (+) or disable (-), e.g. '+avx2,-avx512f'"),
+                              cl::value_desc("a1,+a2,-a3,..."),
+                              cl::cat(category)};
+cl::opt<std::string> cache_directory{"cache-dir",
+                                     cl::desc("Reuse the native code of unchanged programs from this directory"),
+                                     cl::value_desc("directory"),
+                                     cl::cat(category)};
+cl::opt<unsigned int> cache_size{"cache-size",
+                                 cl::desc("Size limit of the cache in MB (default: 256)"),
+                                 cl::init(256),
+                                 cl::cat(category)};
+cl::opt<bool> cache_stats{"cache-stats",
+                          cl::desc("Print the hits and the size of the cache when done"),
+                          cl::cat(category)};
 cl::opt<bool> show_cfg{"show-cfg", cl::desc("Show CFG or create an image of it"), cl::cat(category)};
 cl::opt<bool> show_ast{"show-ast", cl::desc("Print the internally used AST"), cl::cat(category)};
+cl::opt<bool> concurrent_lexing{"concurrent-lexing",
+                                cl::desc("Lex on a separate thread while parsing"),
+                                cl::cat(category)};
+cl::opt<unsigned int> parse_threads{"parse-threads",
+                                   cl::desc("Parse the top-level statements on the given number of threads"),
+                                   cl::init(1),
+                                   cl::cat(category)};
+cl::opt<bool> flat_ast{"flat-ast",
+                       cl::desc("Flatten the AST into a compact array layout before processing it"),
+                       cl::cat(category)};
+cl::opt<bool> interpret{"interpret",
+                        cl::desc("Run the program in the bytecode interpreter instead of compiling it with LLVM"),
+                        cl::cat(category)};
+cl::opt<bool> tiered{"tiered",
+                     cl::desc("Start in the bytecode interpreter and continue in native code once it is compiled"),
+                     cl::cat(category)};
+cl::opt<std::string> serve{"serve",
+                           cl::desc("Serve the requests of bitsyc-client on a Unix domain socket (default: "
+                                    "$BITSYC_SOCKET, $XDG_RUNTIME_DIR/bitsyc.sock or /tmp/bitsyc-<uid>/bitsyc.sock)"),
+                           cl::value_desc("socket"),
+                           cl::ValueOptional,
+                           cl::cat(category)};
+enum class ProfileFormat { text, json };
+// Without a value, the default format is chosen.
+struct ProfileFormatParser : cl::parser<ProfileFormat> {
+    using cl::parser<ProfileFormat>::parser;
+
+    bool parse(cl::Option &option, const llvm::StringRef name, const llvm::StringRef value, ProfileFormat &format) {
+        if (value.empty()) {
+            format = ProfileFormat::text;
+            return false;
+        }
+        return cl::parser<ProfileFormat>::parse(option, name, value, format);
+    }
+};
+cl::opt<ProfileFormat, false, ProfileFormatParser> time_phases{
+    "time-phases",
+    cl::desc("Print the time and the memory spent in every phase of the compiler to the standard error, together "
+             "with the sizes of the intermediate results"),
+    cl::values(clEnumValN(ProfileFormat::text, "text", "Print a table (default)"),
+               clEnumValN(ProfileFormat::json, "json", "Print a JSON object")),
+    cl::ValueOptional,
+    cl::init(ProfileFormat::text),
+    cl::cat(category)};
 
 }} // namespace ::opt
 
-int main(int argc, char *argv[]) {
-    cl::HideUnrelatedOptions(opt::category);
-    cl::ParseCommandLineOptions(argc, argv, "Compiler for Bitsy programs", nullptr, nullptr, true);
+namespace {
+
+const char *const overview = "Compiler for Bitsy programs";
+
+// Only exists with '--time-phases'.
+std::optional<PhaseProfile> profile;
+
+PhaseProfile::Scope measure(const llvm::StringRef phase) {
+    return profile ? profile->measure(phase) : PhaseProfile::Scope{};
+}
+
+void count(const llvm::StringRef counter, const std::uint64_t value) {
+    if (profile) {
+        profile->count(counter, value);
+    }
+}
+
+void print_profile() {
+    if (!profile) {
+        return;
+    }
+    // The program's output comes first.
+    std::fflush(stdout);
+    llvm::outs().flush();
+    if (opt::time_phases == opt::ProfileFormat::json) {
+        profile->print_json(llvm::errs());
+    } else {
+        profile->print(llvm::errs());
+    }
+}
+
+std::optional<llvm::OptimizationLevel> get_optimization_level() {
+    if (opt::no_optimization) {
+        return std::nullopt;
+    }
+    switch (opt::optimization_level) {
+        case opt::OptimizationLevel::O0:
+            return llvm::OptimizationLevel::O0;
+        case opt::OptimizationLevel::O1:
+            return llvm::OptimizationLevel::O1;
+        case opt::OptimizationLevel::O2:
+            return llvm::OptimizationLevel::O2;
+        case opt::OptimizationLevel::O3:
+            return llvm::OptimizationLevel::O3;
+        case opt::OptimizationLevel::Os:
+            return llvm::OptimizationLevel::Os;
+    }
+    llvm_unreachable("Unknown optimization level.");
+}
+
+std::string get_output_name() {
+    if (opt::emit == OutputKind::executable || opt::output_name.getNumOccurrences() > 0) {
+        return opt::output_name;
+    }
+    auto extension = []() {
+        switch (opt::emit) {
+            case OutputKind::object:
+                return ".o";
+            case OutputKind::assembly:
+                return ".s";
+            case OutputKind::bitcode:
+                return ".bc";
+            case OutputKind::executable:
+                break;
+        }
+        llvm_unreachable("Unknown output kind.");
+    }();
+    return std::filesystem::path{opt::input_names.front()}.filename().replace_extension(extension).string();
+}
+
+void print_statistics(const std::optional<CompilationCache> &cache) {
+    if (cache && opt::cache_stats) {
+        cache->print_statistics(llvm::errs());
+    }
+}
 
-    std::ifstream file_stream{opt::input_name};
-    if (!file_stream.good()) {
+// Functions are compiled lazily, so the code generation of all but 'main' is part of the execution.
+int execute(ModuleProcessor &processor) {
+    if (!profile) {
+        return processor.execute();
+    }
+    std::unique_ptr<llvm::orc::LLLazyJIT> jit;
+    std::atomic<std::uint64_t> object_bytes = 0;
+    int (*main_function)() = nullptr;
+    {
+        auto phase = measure("code generation");
+        jit = processor.create_jit();
+        if (!jit) {
+            return 1;
+        }
+        jit->getObjTransformLayer().setTransform([&object_bytes](std::unique_ptr<llvm::MemoryBuffer> object)
+                                                     -> llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> {
+            object_bytes += object->getBufferSize();
+            return object;
+        });
+        auto found_main = ModuleProcessor::find_main(*jit);
+        if (!found_main) {
+            llvm::logAllUnhandledErrors(found_main.takeError(), llvm::errs(), "Cannot compile the program: ");
+            return 1;
+        }
+        main_function = *found_main;
+    }
+    auto result = [&]() {
+        auto phase = measure("execution");
+        return main_function();
+    }();
+    count("object bytes", object_bytes);
+    return result;
+}
+
+// The program is compiled once and then runs on all inputs concurrently, every run with its own input and output.
+int run_on_inputs(const TargetDescription &target) {
+    if (opt::input_names.size() > 1 || opt::interpret || opt::tiered || opt::compile ||
+        opt::emit != OutputKind::executable || opt::show_ast || opt::show_cfg || opt::quiet) {
+        std::cerr << "Only a single program can be run on several inputs."
+                  << "\n";
+        return 1;
+    }
+    auto file_buffer = llvm::MemoryBuffer::getFile(opt::input_names.front(), false, false);
+    if (!file_buffer) {
         std::cerr << "Cannot open the input file."
                   << "\n";
         return 1;
     }
+    CompiledProgram program{(*file_buffer)->getBuffer(), {get_optimization_level(), target}};
+    InputRunner runner{program, opt::inputs};
+
+    // Without an output directory, the outputs follow each other on the standard output.
+    auto write_files = opt::output_directory.getNumOccurrences() > 0;
+    unsigned int write_failures = 0;
+    auto failures = runner.run(opt::jobs, [&](const std::string &input_name, const llvm::StringRef output) {
+        if (!write_files) {
+            llvm::outs() << output;
+            return;
+        }
+        auto output_name = std::filesystem::path{opt::output_directory.getValue()} /
+                           std::filesystem::path{input_name}.filename().concat(".out");
+        std::error_code error_code;
+        llvm::raw_fd_ostream stream{output_name.string(), error_code};
+        stream << output;
+        if (error_code || stream.has_error()) {
+            stream.clear_error();
+            llvm::errs() << "Cannot write the output file " << output_name.string() << "." << '\n';
+            ++write_failures;
+        }
+    });
+    llvm::outs().flush();
+    failures += write_failures;
+    if (failures > 0) {
+        std::cerr << failures << " of " << runner.get_input_names().size() << " inputs failed."
+                  << "\n";
+        return 3;
+    }
+    return 0;
+}
 
-    Lexer<std::istreambuf_iterator<char>> lexer{file_stream, {}};
-    std::vector<Token> tokens{lexer, decltype(lexer)()};
+int run() {
+    if (opt::input_names.empty()) {
+        std::cerr << "No input file given."
+                  << "\n";
+        return 1;
+    }
 
-    Parser parser{tokens};
-    auto main_block = parser.parse();
+    const TargetDescription target{opt::cpu, opt::features};
+    if (!target.is_supported()) {
+        std::cerr << "Unknown processor '" << opt::cpu << "'."
+                  << "\n";
+        return 1;
+    }
 
-    ModuleBuilder builder{main_block.get()};
+    if (!opt::inputs.empty()) {
+        return run_on_inputs(target);
+    }
 
-    ModuleProcessor processor{builder.build(), opt::output_name};
-    if (processor.verify()) {
-        return 2;
+    // Several inputs are compiled side by side. None of them is executed.
+    if (opt::input_names.size() > 1 || std::filesystem::is_directory(opt::input_names.front())) {
+        if (opt::interpret || opt::tiered || opt::show_ast || opt::show_cfg) {
+            std::cerr << "Several inputs can only be compiled."
+                      << "\n";
+            return 1;
+        }
+        BatchCompiler compiler{{opt::input_names.begin(), opt::input_names.end()},
+                               opt::output_directory,
+                               opt::emit,
+                               get_optimization_level(),
+                               target};
+        for (const auto &directory : compiler.get_empty_directories()) {
+            std::cerr << "No Bitsy files in " << directory << "."
+                      << "\n";
+        }
+        if (!compiler.get_empty_directories().empty()) {
+            return 1;
+        }
+        auto failures = compiler.compile(opt::jobs);
+        if (failures > 0) {
+            std::cerr << failures << " of " << compiler.get_input_names().size() << " files failed to compile."
+                      << "\n";
+            return 3;
+        }
+        return 0;
     }
+
+    // Large files get memory-mapped. Tokens refer to the buffer directly, so it must outlive the parsed program.
+    auto file_buffer = llvm::MemoryBuffer::getFile(opt::input_names.front(), false, false);
+    if (!file_buffer) {
+        std::cerr << "Cannot open the input file."
+                  << "\n";
+        return 1;
+    }
+
+    // Unchanged programs are neither parsed nor compiled again if their native code is in the cache.
+    std::optional<CompilationCache> cache;
+    auto output_file = std::filesystem::current_path() / get_output_name();
+    if (!opt::cache_directory.empty() && !opt::interpret && !opt::tiered && !opt::show_ast && !opt::show_cfg &&
+        opt::emit == OutputKind::executable) {
+        cache.emplace(opt::cache_directory.getValue(),
+                      std::uintmax_t{opt::cache_size} * 1024 * 1024,
+                      (*file_buffer)->getBuffer(),
+                      target,
+                      get_optimization_level());
+        if (opt::quiet && opt::compile && cache->retrieve_executable(output_file)) {
+            cache->count_hit();
+            print_statistics(cache);
+            return 0;
+        }
+        // The executable is only worth copying if the program can be run from the cache as well.
+        if (!opt::quiet && cache->load_object() && (!opt::compile || cache->retrieve_executable(output_file))) {
+            llvm::orc::ThreadSafeContext llvm_context{std::make_unique<llvm::LLVMContext>()};
+            auto module = std::make_unique<llvm::Module>("Bitsy Program", *llvm_context.getContext());
+            module->setTargetTriple(llvm::sys::getDefaultTargetTriple());
+            ModuleProcessor processor{{std::move(module), llvm_context}, "", target};
+            processor.set_object_cache(&*cache);
+            cache->count_hit();
+            auto result = execute(processor);
+            print_statistics(cache);
+            return result;
+        }
+        cache->count_miss();
+    }
+
+    SymbolTable symbols;
+    ASTContext context;
+    Program *main_block;
+    if (opt::parse_threads > 1) {
+        auto phase = measure("parsing");
+        ParallelParser parser{(*file_buffer)->getBufferStart(),
+                              (*file_buffer)->getBufferEnd(),
+                              symbols,
+                              context,
+                              opt::parse_threads};
+        main_block = parser.parse();
+    } else {
+        Lexer<const char *> lexer{(*file_buffer)->getBufferStart(), (*file_buffer)->getBufferEnd(), symbols};
+        auto token_source = TokenStream::make_source(lexer, decltype(lexer)());
+        // Lexing is only measured on its own if it does not overlap with the parsing.
+        std::vector<Token> tokens;
+        if (profile && !opt::concurrent_lexing) {
+            auto phase = measure("lexing");
+            for (; lexer != decltype(lexer)(); ++lexer) {
+                tokens.push_back(*lexer);
+            }
+            token_source = TokenStream::make_source(tokens.cbegin(), tokens.cend());
+            count("tokens", tokens.size());
+        }
+        if (opt::concurrent_lexing) {
+            token_source = ConcurrentTokenSource{std::move(token_source)};
+        }
+        auto phase = measure("parsing");
+        // The parser must be gone before the symbols are used. A concurrent lexer might still be running otherwise.
+        main_block = Parser{TokenStream{std::move(token_source)}, context}.parse();
+    }
+    count("AST nodes", context.get_node_count());
+    count("AST bytes", context.get_allocated_bytes());
+
     if (!opt::no_optimization) {
-        processor.optimize();
+        auto phase = measure("AST optimization");
+        ASTOptimizer{context}.optimize(main_block);
     }
-    if (opt::compile) {
-        if (processor.compile() != 0) {
-            return 3;
+
+    std::optional<FlatAST> flat_program;
+    if (opt::flat_ast) {
+        auto phase = measure("flattening");
+        flat_program.emplace(main_block);
+    }
+    if (opt::show_ast) {
+        if (flat_program) {
+            ASTPrinter<FlatAST>(symbols).visit(flat_program->get_root());
+        } else {
+            ASTPrinter(symbols).visit(llvm::cast<Statement>(main_block));
+        }
+    }
+
+    if (opt::interpret || opt::tiered) {
+        Bytecode bytecode;
+        {
+            auto phase = measure("bytecode generation");
+            if (flat_program) {
+                BytecodeGenerator<FlatAST>{bytecode, symbols}.visit(flat_program->get_root());
+            } else {
+                BytecodeGenerator<>{bytecode, symbols}.visit(llvm::cast<Statement>(main_block));
+            }
+        }
+        count("bytecode instructions", bytecode.instructions.size());
+        if (opt::quiet || opt::show_ast) {
+            return 0;
+        }
+        if (!opt::tiered) {
+            auto phase = measure("execution");
+            return Interpreter{bytecode}.execute();
+        }
+        auto builder = flat_program ? ModuleBuilder{&*flat_program, symbols, true}
+                                    : ModuleBuilder{main_block, symbols, true};
+        TieredExecutor executor{bytecode, builder, get_optimization_level(), target};
+        auto result = [&]() {
+            // Includes the native code generation running alongside.
+            auto phase = measure("execution");
+            return executor.execute();
+        }();
+        // Short programs end before their native code is ready. There is no point in waiting for the compiler then.
+        std::fflush(stdout);
+        print_profile();
+        std::_Exit(result);
+    }
+
+    auto builder = flat_program ? ModuleBuilder{&*flat_program, symbols} : ModuleBuilder{main_block, symbols};
+
+    auto processor = [&]() {
+        auto phase = measure("IR generation");
+        return ModuleProcessor{builder.build(), get_output_name(), target};
+    }();
+    processor.set_object_cache(cache ? &*cache : nullptr);
+    if (profile) {
+        count("IR instructions", processor.get_instruction_count());
+    }
+    {
+        auto phase = measure("verification");
+        if (processor.verify()) {
+            return 2;
+        }
+    }
+    if (auto optimization_level = get_optimization_level()) {
+        {
+            auto phase = measure("optimization");
+            processor.optimize(*optimization_level);
+        }
+        if (profile) {
+            count("optimized IR instructions", processor.get_instruction_count());
+        }
+    }
+    if (opt::compile || opt::emit != OutputKind::executable) {
+        {
+            auto phase = measure("code generation");
+            if (processor.compile(opt::emit) != 0) {
+                return 3;
+            }
+        }
+        std::error_code error_code;
+        auto output_bytes = std::filesystem::file_size(get_output_name(), error_code);
+        count("output bytes", error_code ? 0 : output_bytes);
+        if (cache) {
+            cache->store_executable(output_file);
         }
     }
     if (opt::show_cfg) {
@@ -66,11 +530,77 @@ int main(int argc, char *argv[]) {
             return 4;
         }
     }
-    if (opt::show_ast) {
-        ASTPrinter().visit(llvm::cast<Statement>(main_block.get()));
-    }
     if (opt::quiet || opt::show_cfg || opt::show_ast) {
+        print_statistics(cache);
         return 0;
     }
-    return processor.execute();
+    auto result = execute(processor);
+    print_statistics(cache);
+    return result;
+}
+
+int run_with_profile() {
+    if (opt::time_phases.getNumOccurrences() > 0) {
+        profile.emplace();
+    }
+    auto result = run();
+    print_profile();
+    return result;
+}
+
+// Compiles a small program once, so that the targets are initialized and most of the compiler is paged in before the
+// first request is forked off.
+void warm_up() {
+    const std::string source = "BEGIN i = 0 LOOP i = i + 1 IFZ i - 10 BREAK END END PRINT i END";
+    SymbolTable symbols;
+    ASTContext context;
+    Lexer<const char *> lexer{source.data(), source.data() + source.size(), symbols};
+    auto *main_block = Parser{TokenStream{lexer, decltype(lexer)()}, context}.parse();
+    ASTOptimizer{context}.optimize(main_block);
+    ModuleBuilder builder{main_block, symbols};
+    ModuleProcessor processor{builder.build(), ""};
+    processor.optimize(llvm::OptimizationLevel::O2);
+    if (auto jit = processor.create_jit()) {
+        llvm::consumeError(jit->lookup("main").takeError());
+    }
+}
+
+int serve() {
+    CompileServer server{opt::serve.empty() ? get_default_socket_path() : opt::serve.getValue()};
+    if (!server.listen()) {
+        return 1;
+    }
+    warm_up();
+    std::cerr << "Serving requests on " << server.get_socket_path() << "."
+              << "\n";
+    // Every request runs in a process of its own, which parses its command line from scratch.
+    server.serve([](const std::vector<std::string> &arguments) {
+        std::vector<const char *> argv;
+        for (const auto &argument : arguments) {
+            argv.push_back(argument.c_str());
+        }
+        cl::ResetAllOptionOccurrences();
+        if (!cl::ParseCommandLineOptions(
+                static_cast<int>(argv.size()), argv.data(), overview, &llvm::errs(), nullptr, true)) {
+            return 1;
+        }
+        if (opt::serve.getNumOccurrences() > 0) {
+            std::cerr << "A request cannot start another server."
+                      << "\n";
+            return 1;
+        }
+        return run_with_profile();
+    });
+    return 1;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    cl::HideUnrelatedOptions(opt::category);
+    cl::ParseCommandLineOptions(argc, argv, overview, nullptr, nullptr, true);
+    if (opt::serve.getNumOccurrences() > 0) {
+        return serve();
+    }
+    return run_with_profile();
 }
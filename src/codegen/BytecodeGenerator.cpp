@@ -0,0 +1,275 @@
+#include "codegen/BytecodeGenerator.hpp"
+
+#include "ast/FlatAST.hpp"
+
+#include "llvm/Support/ErrorHandling.h"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+
+namespace {
+
+constexpr Register temporary_flag = Register{1} << 31;
+
+Instruction::Opcode get_opcode(const char operator_symbol) {
+    using enum Instruction::Opcode;
+    switch (operator_symbol) {
+        case '+':
+            return add;
+        case '-':
+            return subtract;
+        case '*':
+            return multiply;
+        case '/':
+            return divide;
+        case '%':
+            return remainder;
+        default:
+            llvm_unreachable("Unknown binary operator.");
+    }
+}
+
+Instruction::Opcode get_opcode(const IfStatementType type) {
+    using enum Instruction::Opcode;
+    switch (type) {
+        case IfStatementType::zero:
+            return jump_unless_zero;
+        case IfStatementType::positive:
+            return jump_unless_positive;
+        case IfStatementType::negative:
+            return jump_unless_negative;
+    }
+    llvm_unreachable("Unknown 'IfStatement' type.");
+}
+
+} // namespace
+
+template <class Nodes>
+BytecodeGenerator<Nodes>::BytecodeGenerator(Bytecode &bytecode, const SymbolTable &symbols)
+  : bytecode(bytecode)
+  , had_break(false)
+  , temporary_count(0)
+  , max_temporary_count(0)
+  , loop_count(0) {
+    // The first registers belong to the variables, indexed by their symbols.
+    bytecode.registers.assign(symbols.size(), 0);
+}
+
+template <class Nodes>
+void BytecodeGenerator<Nodes>::visit(typename Nodes::Program program) {
+    schedule([this]() {
+        create_instruction({Instruction::Opcode::halt});
+        relocate_temporaries();
+    });
+    schedule_visit(program->block);
+    while (!pending_tasks.empty()) {
+        auto task = std::move(pending_tasks.back());
+        pending_tasks.pop_back();
+        task();
+    }
+}
+
+template <class Nodes>
+void BytecodeGenerator<Nodes>::visit(typename Nodes::Block block) {
+    visit_statements(block->statements.begin(), block->statements.end());
+}
+
+template <class Nodes>
+template <class StatementIterator>
+void BytecodeGenerator<Nodes>::visit_statements(StatementIterator current, const StatementIterator end) {
+    for (; current != end && !had_break; ++current) {
+        auto pending_task_count = pending_tasks.size();
+        visit(*current);
+        if (pending_tasks.size() != pending_task_count) {
+            // The statement scheduled its nested blocks. The rest of this block has to wait for them.
+            auto continuation = [this, next = std::next(current), end]() {
+                visit_statements(next, end);
+            };
+            pending_tasks.emplace(pending_tasks.begin() + static_cast<std::ptrdiff_t>(pending_task_count),
+                                  std::move(continuation));
+            return;
+        }
+    }
+}
+
+template <class Nodes>
+void BytecodeGenerator<Nodes>::visit(typename Nodes::IfStatement if_statement) {
+    auto condition = visit(if_statement->expression);
+    release(condition);
+    auto condition_jump = create_instruction({get_opcode(if_statement->type), 0, condition});
+
+    if (if_statement->else_block) {
+        schedule([this, condition_jump, else_statements = if_statement->else_block]() {
+            std::optional<std::size_t> then_jump;
+            if (!had_break) {
+                then_jump = create_instruction({Instruction::Opcode::jump});
+            }
+            had_break = false;
+            set_jump_target(condition_jump);
+            schedule([this, then_jump]() {
+                if (then_jump) {
+                    set_jump_target(*then_jump);
+                }
+                had_break = false;
+            });
+            schedule_visit(else_statements);
+        });
+    } else {
+        schedule([this, condition_jump]() {
+            set_jump_target(condition_jump);
+            had_break = false;
+        });
+    }
+    schedule_visit(if_statement->then_block);
+}
+
+template <class Nodes>
+void BytecodeGenerator<Nodes>::visit(typename Nodes::LoopStatement loop_statement) {
+    auto loop_start = static_cast<Register>(bytecode.instructions.size());
+    loop_breaks.emplace_back();
+    schedule([this, loop_start, loop = loop_count++]() {
+        if (!had_break) {
+            create_instruction({Instruction::Opcode::jump_back, loop_start, loop});
+        }
+        for (auto break_jump : loop_breaks.back()) {
+            set_jump_target(break_jump);
+        }
+        loop_breaks.pop_back();
+        had_break = false;
+    });
+    schedule_visit(loop_statement->block);
+}
+
+template <class Nodes>
+void BytecodeGenerator<Nodes>::visit(typename Nodes::PrintStatement print_statement) {
+    auto value = visit(print_statement->expression);
+    release(value);
+    create_instruction({Instruction::Opcode::print, 0, value});
+}
+
+template <class Nodes>
+void BytecodeGenerator<Nodes>::visit(typename Nodes::ReadStatement read_statement) {
+    create_instruction({Instruction::Opcode::read, visit(read_statement->variable_expression)});
+}
+
+template <class Nodes>
+void BytecodeGenerator<Nodes>::visit(typename Nodes::AssignmentStatement assignment_statement) {
+    auto variable = visit(assignment_statement->variable);
+    // The last operation of the expression stores its result in the variable directly.
+    auto value = Nodes::dispatch(assignment_statement->expression, [&](auto expression) -> Register {
+        if constexpr (std::is_same_v<decltype(expression), typename Nodes::BinaryOperationExpression>) {
+            return create_operations(expression, variable);
+        } else {
+            return visit(expression);
+        }
+    });
+    if (value != variable) {
+        create_instruction({Instruction::Opcode::move, variable, value});
+    }
+}
+
+template <class Nodes>
+void BytecodeGenerator<Nodes>::visit(typename Nodes::BreakStatement break_statement) {
+    (void)break_statement;
+    if (loop_breaks.empty()) {
+        throw std::logic_error("BREAK outside of a loop.");
+    }
+    loop_breaks.back().push_back(create_instruction({Instruction::Opcode::jump}));
+    had_break = true;
+}
+
+template <class Nodes>
+Register BytecodeGenerator<Nodes>::visit(typename Nodes::NumberExpression number_expression) {
+    auto [constant, inserted] =
+        constants.try_emplace(number_expression->value, static_cast<Register>(bytecode.registers.size()));
+    if (inserted) {
+        bytecode.registers.push_back(number_expression->value);
+    }
+    return constant->second;
+}
+
+template <class Nodes>
+Register BytecodeGenerator<Nodes>::visit(typename Nodes::VariableExpression variable_expression) {
+    return variable_expression->symbol;
+}
+
+template <class Nodes>
+Register BytecodeGenerator<Nodes>::visit(typename Nodes::BinaryOperationExpression binary_operation_expression) {
+    return create_operations(binary_operation_expression, std::nullopt);
+}
+
+template <class Nodes>
+Register BytecodeGenerator<Nodes>::create_operations(
+    typename Nodes::BinaryOperationExpression binary_operation_expression,
+    const std::optional<Register> result) {
+    // Only the outermost operation writes to the requested register.
+    return visit_post_order<Nodes, Register>(
+        binary_operation_expression,
+        [this](auto expression) {
+            return visit(expression);
+        },
+        [this, result](auto operation, const Register lhs, const Register rhs, const bool outermost) {
+            release(rhs);
+            release(lhs);
+            auto target = outermost && result ? *result : create_temporary();
+            create_instruction({get_opcode(operation->operator_symbol), target, lhs, rhs});
+            return target;
+        });
+}
+
+template <class Nodes>
+std::size_t BytecodeGenerator<Nodes>::create_instruction(const Instruction instruction) {
+    bytecode.instructions.push_back(instruction);
+    return bytecode.instructions.size() - 1;
+}
+
+template <class Nodes>
+void BytecodeGenerator<Nodes>::set_jump_target(const std::size_t jump) {
+    bytecode.instructions[jump].target = static_cast<Register>(bytecode.instructions.size());
+}
+
+template <class Nodes>
+Register BytecodeGenerator<Nodes>::create_temporary() {
+    auto temporary = temporary_flag | temporary_count++;
+    max_temporary_count = std::max(max_temporary_count, temporary_count);
+    return temporary;
+}
+
+template <class Nodes>
+void BytecodeGenerator<Nodes>::release(const Register value) {
+    // Temporaries are used in the order they are created, so the released one is always the latest.
+    if ((value & temporary_flag) != 0) {
+        --temporary_count;
+    }
+}
+
+template <class Nodes>
+void BytecodeGenerator<Nodes>::relocate_temporaries() {
+    auto first_temporary = static_cast<Register>(bytecode.registers.size());
+    bytecode.registers.resize(first_temporary + max_temporary_count);
+    auto relocate = [first_temporary](Register &value) {
+        if ((value & temporary_flag) != 0) {
+            value = first_temporary + (value & ~temporary_flag);
+        }
+    };
+    for (auto &instruction : bytecode.instructions) {
+        using enum Instruction::Opcode;
+        switch (instruction.opcode) {
+            case jump:
+            case jump_back:
+            case jump_unless_zero:
+            case jump_unless_positive:
+            case jump_unless_negative:
+                break;
+            default:
+                relocate(instruction.target);
+        }
+        relocate(instruction.lhs);
+        relocate(instruction.rhs);
+    }
+}
+
+template class BytecodeGenerator<TreeNodes>;
+template class BytecodeGenerator<FlatAST>;
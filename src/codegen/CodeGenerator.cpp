@@ -1,137 +1,231 @@
 #include "codegen/CodeGenerator.hpp"
 
+#include "ast/FlatAST.hpp"
+#include "runtime/Runtime.hpp"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/Constants.h"
 #include "llvm/IR/Function.h"
 #include "llvm/Support/Host.h"
 
+#include <cstdint>
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <stdexcept>
 #include <unordered_map>
+#include <utility>
 
-CodeGenerator::CodeGenerator(llvm::Module &module)
+template <class Nodes>
+CodeGenerator<Nodes>::CodeGenerator(llvm::Module &module,
+                                    const SymbolTable &symbols,
+                                    const bool resumable,
+                                    const bool checked_division)
   : module(module)
   , builder(module.getContext())
   , had_break(false)
-  , read_template(builder.CreateGlobalStringPtr("%i", "read_template", 0, &module))
-  , print_template(builder.CreateGlobalStringPtr("%i\n", "print_template", 0, &module)) {
+  , resumable(resumable)
+  , start_block(nullptr)
+  , loop_count(0)
+  , checked_division(checked_division)
+  , division_error_block(nullptr)
+  , symbols(symbols)
+  , definitions(symbols.size()) {
     module.setTargetTriple(llvm::sys::getDefaultTargetTriple());
 
     llvm::FunctionType *return_type = llvm::FunctionType::get(builder.getInt32Ty(), false);
+    if (resumable) {
+        return_type = llvm::FunctionType::get(builder.getInt32Ty(),
+                                              {builder.getInt32Ty()->getPointerTo(), builder.getInt32Ty()},
+                                              false);
+    }
     main_function = llvm::Function::Create(return_type, llvm::Function::ExternalLinkage, "main", &module);
     main_block = llvm::BasicBlock::Create(module.getContext(), "main_block", main_function);
+    sealed_blocks.insert(main_block);
+    if (resumable) {
+        // The main block only sets up the variables and jumps to the start of the program or the requested loop.
+        start_block = llvm::BasicBlock::Create(module.getContext(), "start_block", main_function);
+    }
 }
 
-void CodeGenerator::visit(const Program *program) {
-    builder.SetInsertPoint(main_block);
-    visit(program->block.get());
-    builder.CreateRet(llvm::ConstantInt::get(builder.getInt32Ty(), 0));
+template <class Nodes>
+void CodeGenerator<Nodes>::visit(typename Nodes::Program program) {
+    if (resumable) {
+        // Loops add themselves to the switch, so their blocks know all of their predecessors when being sealed.
+        builder.SetInsertPoint(main_block);
+        builder.CreateSwitch(main_function->getArg(1), start_block);
+        seal_block(start_block);
+    }
+    builder.SetInsertPoint(resumable ? start_block : main_block);
+    schedule([this]() {
+        create_flush();
+        builder.CreateRet(llvm::ConstantInt::get(builder.getInt32Ty(), 0));
+    });
+    schedule_visit(program->block);
+    while (!pending_tasks.empty()) {
+        auto task = std::move(pending_tasks.back());
+        pending_tasks.pop_back();
+        task();
+    }
 }
 
-void CodeGenerator::visit(const Block *block) {
-    for (const auto &statement : block->statements) {
-        if (had_break) {
+template <class Nodes>
+void CodeGenerator<Nodes>::visit(typename Nodes::Block block) {
+    visit_statements(block->statements.begin(), block->statements.end());
+}
+
+template <class Nodes>
+template <class StatementIterator>
+void CodeGenerator<Nodes>::visit_statements(StatementIterator current, const StatementIterator end) {
+    for (; current != end && !had_break; ++current) {
+        auto pending_task_count = pending_tasks.size();
+        visit(*current);
+        if (pending_tasks.size() != pending_task_count) {
+            // The statement scheduled its nested blocks. The rest of this block has to wait for them.
+            auto continuation = [this, next = std::next(current), end]() {
+                visit_statements(next, end);
+            };
+            pending_tasks.emplace(pending_tasks.begin() + static_cast<std::ptrdiff_t>(pending_task_count),
+                                  std::move(continuation));
             return;
         }
-        visit(statement.get());
     }
 }
 
-void CodeGenerator::visit(const IfStatement *if_statement) {
+template <class Nodes>
+void CodeGenerator<Nodes>::visit(typename Nodes::IfStatement if_statement) {
     auto then_block = llvm::BasicBlock::Create(module.getContext(), "then_block", main_function);
     auto continuation_block = llvm::BasicBlock::Create(module.getContext(), "continuation_block", main_function);
 
     auto condition = create_if_condition(if_statement);
-    llvm::BasicBlock *else_block;
+    llvm::BasicBlock *else_block = nullptr;
     if (if_statement->else_block) {
         else_block = llvm::BasicBlock::Create(module.getContext(), "else_block", main_function);
         builder.CreateCondBr(condition, then_block, else_block);
     } else {
         builder.CreateCondBr(condition, then_block, continuation_block);
     }
-
-    builder.SetInsertPoint(then_block);
-    visit(if_statement->then_block.get());
-    if (!had_break) {
-        builder.CreateBr(continuation_block);
+    seal_block(then_block);
+    if (else_block) {
+        seal_block(else_block);
     }
-    had_break = false;
 
-    if (if_statement->else_block) {
-        builder.SetInsertPoint(else_block);
-        visit(if_statement->else_block.get());
+    auto finish_branch = [this, continuation_block]() {
         if (!had_break) {
             builder.CreateBr(continuation_block);
         }
         had_break = false;
+    };
+    auto finish_block = [this, finish_branch, continuation_block]() {
+        finish_branch();
+        seal_block(continuation_block);
+        builder.SetInsertPoint(continuation_block);
+    };
+    builder.SetInsertPoint(then_block);
+    if (if_statement->else_block) {
+        schedule([this, finish_branch, finish_block, else_block, else_statements = if_statement->else_block]() {
+            finish_branch();
+            builder.SetInsertPoint(else_block);
+            schedule(finish_block);
+            schedule_visit(else_statements);
+        });
+    } else {
+        schedule(finish_block);
     }
-
-    builder.SetInsertPoint(continuation_block);
+    schedule_visit(if_statement->then_block);
 }
 
-void CodeGenerator::visit(const LoopStatement *loop_statement) {
+template <class Nodes>
+void CodeGenerator<Nodes>::visit(typename Nodes::LoopStatement loop_statement) {
     auto loop_block = llvm::BasicBlock::Create(module.getContext(), "loop_block", main_function);
+    if (resumable) {
+        llvm::cast<llvm::SwitchInst>(main_block->getTerminator())
+            ->addCase(builder.getInt32(loop_count++), loop_block);
+    }
     auto after_loop_block = llvm::BasicBlock::Create(module.getContext(), "after_loop_block", main_function);
     loop_continuation_hierarchy.push(after_loop_block);
     builder.CreateBr(loop_block);
 
     builder.SetInsertPoint(loop_block);
-    visit(loop_statement->block.get());
-    if (!had_break || loop_continuation_hierarchy.size() != 1) {
-        builder.CreateBr(loop_block);
-    }
-    loop_continuation_hierarchy.pop();
-    had_break = false;
+    schedule([this, loop_block, after_loop_block]() {
+        if (!had_break) {
+            builder.CreateBr(loop_block);
+        }
+        loop_continuation_hierarchy.pop();
+        had_break = false;
 
-    builder.SetInsertPoint(after_loop_block);
+        seal_block(loop_block);
+        seal_block(after_loop_block);
+        builder.SetInsertPoint(after_loop_block);
+    });
+    schedule_visit(loop_statement->block);
 }
 
-void CodeGenerator::visit(const PrintStatement *print_statement) {
+template <class Nodes>
+void CodeGenerator<Nodes>::visit(typename Nodes::PrintStatement print_statement) {
     auto print_function = module.getOrInsertFunction(
-        "printf",
-        llvm::FunctionType::get(builder.getInt32Ty(), builder.getInt8PtrTy(), true));
-    std::vector<llvm::Value *> arguments{print_template, visit(print_statement->expression.get())};
-    builder.CreateCall(print_function, arguments, "print");
+        "bitsy_print_i32",
+        llvm::FunctionType::get(builder.getVoidTy(), builder.getInt32Ty(), false));
+    builder.CreateCall(print_function, visit(print_statement->expression));
 }
 
-void CodeGenerator::visit(const ReadStatement *read_statement) {
+template <class Nodes>
+void CodeGenerator<Nodes>::visit(typename Nodes::ReadStatement read_statement) {
     auto read_function = module.getOrInsertFunction(
-        "scanf",
-        llvm::FunctionType::get(builder.getInt32Ty(), builder.getInt8PtrTy(), true));
-    auto allocated_variable = builder.CreateAlloca(builder.getInt32Ty());
-    known_variables[read_statement->variable_expression->name] = allocated_variable;
-    std::vector<llvm::Value *> arguments{read_template, allocated_variable};
-    builder.CreateCall(read_function, arguments, "read");
-}
-
-void CodeGenerator::visit(const AssignmentStatement *assignment_statement) {
-    auto value = visit(assignment_statement->expression.get());
-    auto variable_name = assignment_statement->variable->name;
-    if (auto known_variable = known_variables[variable_name]) {
-        builder.CreateStore(value, known_variable);
-        return;
-    }
-    builder.CreateStore(value, allocate_variable(variable_name));
+        "bitsy_read_i32",
+        llvm::FunctionType::get(builder.getInt32Ty(), builder.getInt32Ty(), false));
+    auto symbol = read_statement->variable_expression->symbol;
+    auto *block = builder.GetInsertBlock();
+    write_variable(symbol,
+                   block,
+                   builder.CreateCall(read_function, read_variable(symbol, block), symbols.get_name(symbol)));
+}
+
+template <class Nodes>
+void CodeGenerator<Nodes>::visit(typename Nodes::AssignmentStatement assignment_statement) {
+    auto value = visit(assignment_statement->expression);
+    write_variable(assignment_statement->variable->symbol, builder.GetInsertBlock(), value);
 }
 
-void CodeGenerator::visit(const BreakStatement *break_statement) {
+template <class Nodes>
+void CodeGenerator<Nodes>::visit(typename Nodes::BreakStatement break_statement) {
     (void)break_statement;
+    if (loop_continuation_hierarchy.empty()) {
+        throw std::logic_error("BREAK outside of a loop.");
+    }
     builder.CreateBr(loop_continuation_hierarchy.top());
     had_break = true;
 }
 
-llvm::Value *CodeGenerator::visit(const NumberExpression *number_expression) {
+template <class Nodes>
+llvm::Value *CodeGenerator<Nodes>::visit(typename Nodes::NumberExpression number_expression) {
     return llvm::ConstantInt::getSigned(builder.getInt32Ty(), number_expression->value);
 }
 
-llvm::Value *CodeGenerator::visit(const VariableExpression *variable_expression) {
-    if (auto known_variable = known_variables[variable_expression->name]) {
-        return builder.CreateLoad(builder.getInt32Ty(), known_variable);
-    }
-    return builder.CreateLoad(builder.getInt32Ty(), allocate_variable(variable_expression->name));
+template <class Nodes>
+llvm::Value *CodeGenerator<Nodes>::visit(typename Nodes::VariableExpression variable_expression) {
+    return read_variable(variable_expression->symbol, builder.GetInsertBlock());
+}
+
+template <class Nodes>
+llvm::Value *CodeGenerator<Nodes>::visit(typename Nodes::BinaryOperationExpression binary_operation_expression) {
+    return visit_post_order<Nodes, llvm::Value *>(
+        binary_operation_expression,
+        [this](auto expression) {
+            return visit(expression);
+        },
+        [this](auto operation, llvm::Value *lhs, llvm::Value *rhs, bool) {
+            return create_binary_operation(operation->operator_symbol, lhs, rhs);
+        });
 }
 
-llvm::Value *CodeGenerator::visit(const BinaryOperationExpression *binary_operation_expression) {
-    auto lhs = visit(binary_operation_expression->left_expression.get());
-    auto rhs = visit(binary_operation_expression->right_expression.get());
-    switch (binary_operation_expression->operator_symbol) {
+template <class Nodes>
+llvm::Value *CodeGenerator<Nodes>::create_binary_operation(const char operator_symbol, llvm::Value *lhs, llvm::Value *rhs) {
+    if (checked_division && (operator_symbol == '/' || operator_symbol == '%')) {
+        return create_checked_division(operator_symbol, lhs, rhs);
+    }
+    switch (operator_symbol) {
         case '+':
             return builder.CreateAdd(lhs, rhs);
         case '-':
@@ -149,29 +243,223 @@ llvm::Value *CodeGenerator::visit(const BinaryOperationExpression *binary_operat
     }
 }
 
-llvm::Value *CodeGenerator::allocate_variable(const std::string &name) {
-    auto current_insert_point = builder.GetInsertBlock();
-    bool not_in_main_block = main_block != current_insert_point;
-    if (not_in_main_block) {
-        builder.SetInsertPoint(&(*main_block->getFirstInsertionPt()));
+template <class Nodes>
+llvm::Value *CodeGenerator<Nodes>::create_checked_division(const char operator_symbol,
+                                                           llvm::Value *lhs,
+                                                           llvm::Value *rhs) {
+    // Divisions by constants other than 0 and -1 cannot fail.
+    auto *divisor = llvm::dyn_cast<llvm::ConstantInt>(rhs);
+    if (!divisor || divisor->isZero() || divisor->isMinusOne()) {
+        if (!division_error_block) {
+            const llvm::IRBuilderBase::InsertPointGuard guard{builder};
+            division_error_block = llvm::BasicBlock::Create(module.getContext(), "division_error_block", main_function);
+            builder.SetInsertPoint(division_error_block);
+            create_flush();
+            builder.CreateRet(builder.getInt32(bitsy_division_error));
+        }
+        auto *invalid = builder.CreateOr(
+            builder.CreateICmpEQ(rhs, builder.getInt32(0)),
+            builder.CreateAnd(builder.CreateICmpEQ(lhs, builder.getInt32(std::numeric_limits<std::int32_t>::min())),
+                              builder.CreateICmpEQ(rhs, builder.getInt32(-1))));
+        auto *division_block = llvm::BasicBlock::Create(module.getContext(), "division_block", main_function);
+        builder.CreateCondBr(invalid, division_error_block, division_block);
+        seal_block(division_block);
+        builder.SetInsertPoint(division_block);
     }
-    auto new_variable = builder.CreateAlloca(builder.getInt32Ty(), nullptr, name);
-    builder.CreateStore(llvm::ConstantInt::get(builder.getInt32Ty(), 0), new_variable);
-    known_variables[name] = new_variable;
-    if (not_in_main_block) {
-        builder.SetInsertPoint(current_insert_point);
+    return operator_symbol == '/' ? builder.CreateSDiv(lhs, rhs) : builder.CreateSRem(lhs, rhs);
+}
+
+template <class Nodes>
+void CodeGenerator<Nodes>::write_variable(const SymbolID symbol, llvm::BasicBlock *block, llvm::Value *value) {
+    definitions[symbol][block] = value;
+}
+
+template <class Nodes>
+llvm::Value *CodeGenerator<Nodes>::read_variable(const SymbolID symbol, llvm::BasicBlock *block) {
+    llvm::SmallVector<PendingPhi, 8> pending_phis;
+    auto *value = look_up_variable(symbol, block, pending_phis);
+    while (!pending_phis.empty()) {
+        auto &pending_phi = pending_phis.back();
+        if (value) {
+            pending_phi.phi->addIncoming(value, pending_phi.predecessors[pending_phi.next_predecessor - 1]);
+        }
+        if (pending_phi.next_predecessor < pending_phi.predecessors.size()) {
+            auto *predecessor = pending_phi.predecessors[pending_phi.next_predecessor++];
+            // Yields no value if another phi node has to be completed first.
+            value = look_up_variable(symbol, predecessor, pending_phis);
+            continue;
+        }
+        unfinished_phis.erase(pending_phi.phi);
+        value = remove_trivial_phi(pending_phi.phi);
+        for (auto *passed_block : pending_phi.blocks) {
+            write_variable(symbol, passed_block, value);
+        }
+        pending_phis.pop_back();
     }
-    return new_variable;
+    return value;
 }
 
-llvm::Value *CodeGenerator::create_if_condition(const IfStatement *if_statement) {
+template <class Nodes>
+llvm::Value *CodeGenerator<Nodes>::look_up_variable(const SymbolID symbol,
+                                                    llvm::BasicBlock *block,
+                                                    llvm::SmallVectorImpl<PendingPhi> &pending_phis) {
+    // Blocks with a single predecessor are passed through. They remember the value found for later lookups.
+    llvm::SmallVector<llvm::BasicBlock *, 4> passed_blocks;
+    llvm::Value *value = nullptr;
+    while (!value) {
+        if (auto definition = definitions[symbol].find(block); definition != definitions[symbol].end()) {
+            value = resolve(definition->second);
+            break;
+        }
+        passed_blocks.push_back(block);
+        if (!sealed_blocks.contains(block)) {
+            auto *phi = create_phi(symbol, block);
+            incomplete_phis[block].emplace_back(symbol, phi);
+            value = phi;
+            break;
+        }
+        llvm::SmallVector<llvm::BasicBlock *, 2> predecessors{llvm::predecessors(block)};
+        if (predecessors.empty()) {
+            // Blocks other than the main block without predecessors are unreachable.
+            value = block == main_block ? get_initial_value(symbol) : llvm::UndefValue::get(builder.getInt32Ty());
+        } else if (predecessors.size() == 1) {
+            block = predecessors.front();
+        } else {
+            // The phi node is defined before its operands are looked up, which ends lookups running around loops.
+            auto *phi = create_phi(symbol, block);
+            write_variable(symbol, block, phi);
+            pending_phis.push_back({phi, std::move(passed_blocks), std::move(predecessors), 0});
+            return nullptr;
+        }
+    }
+    for (auto *passed_block : passed_blocks) {
+        write_variable(symbol, passed_block, value);
+    }
+    return value;
+}
+
+template <class Nodes>
+llvm::Value *CodeGenerator<Nodes>::get_initial_value(const SymbolID symbol) {
+    if (!resumable) {
+        return builder.getInt32(0);
+    }
+    llvm::IRBuilder<> entry_builder{main_block->getTerminator()};
+    auto variable_address =
+        entry_builder.CreateConstInBoundsGEP1_32(builder.getInt32Ty(), main_function->getArg(0), symbol);
+    return entry_builder.CreateLoad(builder.getInt32Ty(), variable_address, symbols.get_name(symbol));
+}
+
+template <class Nodes>
+llvm::PHINode *CodeGenerator<Nodes>::create_phi(const SymbolID symbol, llvm::BasicBlock *block) {
+    auto *phi = block->empty()
+                    ? llvm::PHINode::Create(builder.getInt32Ty(), 2, symbols.get_name(symbol), block)
+                    : llvm::PHINode::Create(builder.getInt32Ty(), 2, symbols.get_name(symbol), &block->front());
+    unfinished_phis.insert(phi);
+    return phi;
+}
+
+template <class Nodes>
+llvm::Value *CodeGenerator<Nodes>::resolve(llvm::Value *value) {
+    llvm::SmallVector<llvm::PHINode *, 4> replaced_chain;
+    while (auto *phi = llvm::dyn_cast<llvm::PHINode>(value)) {
+        auto replacement = replaced_phis.find(phi);
+        if (replacement == replaced_phis.end()) {
+            break;
+        }
+        replaced_chain.push_back(phi);
+        value = replacement->second;
+    }
+    // Later lookups skip the chain.
+    for (auto *phi : replaced_chain) {
+        replaced_phis[phi] = value;
+    }
+    return value;
+}
+
+template <class Nodes>
+llvm::Value *CodeGenerator<Nodes>::remove_trivial_phi(llvm::PHINode *phi) {
+    // A phi node merging only a single value other than itself is replaced by that value. Phi nodes using it might
+    // become trivial in turn.
+    llvm::SmallVector<llvm::PHINode *, 8> candidates{phi};
+    while (!candidates.empty()) {
+        auto *candidate = candidates.pop_back_val();
+        if (!candidate->getParent() || unfinished_phis.contains(candidate)) {
+            continue;
+        }
+        llvm::Value *same = nullptr;
+        bool trivial = true;
+        for (llvm::Value *operand : candidate->incoming_values()) {
+            if (operand == same || operand == candidate) {
+                continue;
+            }
+            if (same) {
+                trivial = false;
+                break;
+            }
+            same = operand;
+        }
+        if (!trivial) {
+            continue;
+        }
+        for (auto *user : candidate->users()) {
+            if (auto *user_phi = llvm::dyn_cast<llvm::PHINode>(user); user_phi && user_phi != candidate) {
+                candidates.push_back(user_phi);
+            }
+        }
+        if (!same) {
+            same = llvm::UndefValue::get(builder.getInt32Ty());
+        }
+        candidate->replaceUsesWithIf(same, [](const llvm::Use &) {
+            return true;
+        });
+        candidate->dropAllReferences();
+        candidate->removeFromParent();
+        replaced_phis[candidate] = same;
+        removed_phis.emplace_back(candidate);
+    }
+    return resolve(phi);
+}
+
+template <class Nodes>
+void CodeGenerator<Nodes>::seal_block(llvm::BasicBlock *block) {
+    sealed_blocks.insert(block);
+    auto incomplete = incomplete_phis.find(block);
+    if (incomplete == incomplete_phis.end()) {
+        return;
+    }
+    // Reading the operands may add incomplete phis of enclosing blocks, which invalidates the iterator.
+    auto phis = std::move(incomplete->second);
+    incomplete_phis.erase(incomplete);
+    for (auto [symbol, phi] : phis) {
+        for (auto *predecessor : llvm::predecessors(block)) {
+            phi->addIncoming(read_variable(symbol, predecessor), predecessor);
+        }
+    }
+    for (auto [symbol, phi] : phis) {
+        unfinished_phis.erase(phi);
+        remove_trivial_phi(phi);
+    }
+}
+
+template <class Nodes>
+void CodeGenerator<Nodes>::create_flush() {
+    auto flush_function =
+        module.getOrInsertFunction("bitsy_flush", llvm::FunctionType::get(builder.getVoidTy(), false));
+    builder.CreateCall(flush_function);
+}
+
+template <class Nodes>
+llvm::Value *CodeGenerator<Nodes>::create_if_condition(typename Nodes::IfStatement if_statement) {
     using enum IfStatementType;
     using enum llvm::CmpInst::Predicate;
     const std::unordered_map type_predicate_mapping = {std::pair{positive, ICMP_SLT},
                                                        std::pair{zero, ICMP_EQ},
                                                        std::pair{negative, ICMP_SGT}};
-    auto condition = visit(if_statement->expression.get());
+    auto condition = visit(if_statement->expression);
     auto null = llvm::ConstantInt::get(builder.getInt32Ty(), 0);
     auto predicate = type_predicate_mapping.at(if_statement->type);
     return builder.CreateICmp(predicate, null, condition);
 }
+
+template class CodeGenerator<TreeNodes>;
+template class CodeGenerator<FlatAST>;
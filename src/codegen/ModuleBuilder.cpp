@@ -3,12 +3,18 @@
 #include "codegen/CodeGenerator.hpp"
 
 #include <memory>
+#include <utility>
+#include <variant>
 
-std::unique_ptr<llvm::Module> ModuleBuilder::build() const {
-    auto module = std::make_unique<llvm::Module>("Bitsy Program", context);
+llvm::orc::ThreadSafeModule ModuleBuilder::build() const {
+    auto module = std::make_unique<llvm::Module>("Bitsy Program", *context.getContext());
 
-    CodeGenerator generator{*module};
-    generator.visit(llvm::cast<Statement>(program));
+    if (const auto *flat_program = std::get_if<const FlatAST *>(&program)) {
+        CodeGenerator<FlatAST>{*module, symbols, resumable, checked_division}.visit((*flat_program)->get_root());
+    } else {
+        CodeGenerator<>{*module, symbols, resumable, checked_division}.visit(
+            llvm::cast<Statement>(std::get<const Program *>(program)));
+    }
 
-    return module;
+    return {std::move(module), context};
 }
@@ -0,0 +1,157 @@
+#include "execution/BatchCompiler.hpp"
+
+#include "ast/ASTOptimizer.hpp"
+#include "codegen/ModuleBuilder.hpp"
+#include "lexer/Lexer.hpp"
+#include "parser/Parser.hpp"
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <numeric>
+#include <system_error>
+#include <utility>
+
+BatchCompiler::BatchCompiler(const std::vector<std::string> &inputs,
+                             std::string output_directory,
+                             const OutputKind output_kind,
+                             const std::optional<llvm::OptimizationLevel> optimization_level,
+                             TargetDescription target)
+  : output_directory(std::move(output_directory))
+  , output_kind(output_kind)
+  , optimization_level(optimization_level)
+  , target(std::move(target)) {
+    for (const auto &input : inputs) {
+        std::error_code error_code;
+        if (!std::filesystem::is_directory(input, error_code)) {
+            input_names.push_back(input);
+            continue;
+        }
+        auto first_file = input_names.size();
+        for (const auto &entry : std::filesystem::directory_iterator{input, error_code}) {
+            if (entry.is_regular_file() && entry.path().extension() == ".bitsy") {
+                input_names.push_back(entry.path().string());
+            }
+        }
+        if (first_file == input_names.size()) {
+            empty_directories.push_back(input);
+        }
+        std::sort(input_names.begin() + static_cast<std::ptrdiff_t>(first_file), input_names.end());
+    }
+}
+
+unsigned int BatchCompiler::compile(const unsigned int threads, llvm::raw_ostream &diagnostics) const {
+    // Registering the target is not thread-safe. Later calls only find it registered already.
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+
+    struct Job {
+        std::string output_name;
+        std::uintmax_t size = 0;
+        bool succeeded = false;
+        std::string diagnostics;
+    };
+    std::vector<Job> jobs(input_names.size());
+    llvm::StringMap<std::size_t> outputs;
+    for (std::size_t index = 0; index < input_names.size(); ++index) {
+        auto &job = jobs[index];
+        job.output_name = get_output_name(input_names[index]);
+        std::error_code error_code;
+        job.size = std::filesystem::file_size(input_names[index], error_code);
+        if (auto [output, inserted] = outputs.try_emplace(job.output_name, index); !inserted) {
+            job.diagnostics = "The output file '" + job.output_name + "' is written for '" +
+                              input_names[output->second] + "' already.\n";
+        }
+    }
+
+    // Large files are started first, so that no thread is left with one of them at the end.
+    std::vector<std::size_t> order(jobs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&jobs](auto lhs, auto rhs) {
+        return jobs[lhs].size > jobs[rhs].size;
+    });
+    {
+        llvm::ThreadPool pool{llvm::hardware_concurrency(threads)};
+        for (auto index : order) {
+            if (!jobs[index].diagnostics.empty()) {
+                continue;
+            }
+            pool.async([this, &job = jobs[index], &input_name = input_names[index]]() {
+                llvm::raw_string_ostream job_diagnostics{job.diagnostics};
+                job.succeeded = compile_file(input_name, job.output_name, job_diagnostics);
+            });
+        }
+        pool.wait();
+    }
+
+    unsigned int failures = 0;
+    for (std::size_t index = 0; index < jobs.size(); ++index) {
+        llvm::StringRef messages{jobs[index].diagnostics};
+        while (!messages.empty()) {
+            auto [line, rest] = messages.split('\n');
+            diagnostics << input_names[index] << ": " << line << '\n';
+            messages = rest;
+        }
+        if (!jobs[index].succeeded) {
+            ++failures;
+        }
+    }
+    return failures;
+}
+
+std::string BatchCompiler::get_output_name(const std::string &input_name) const {
+    std::filesystem::path output_name{input_name};
+    switch (output_kind) {
+        case OutputKind::executable:
+            output_name.replace_extension();
+            break;
+        case OutputKind::object:
+            output_name.replace_extension(".o");
+            break;
+        case OutputKind::assembly:
+            output_name.replace_extension(".s");
+            break;
+        case OutputKind::bitcode:
+            output_name.replace_extension(".bc");
+            break;
+    }
+    return (std::filesystem::path{output_directory} / output_name.filename()).string();
+}
+
+bool BatchCompiler::compile_file(const std::string &input_name,
+                                 const std::string &output_name,
+                                 llvm::raw_ostream &diagnostics) const {
+    auto file_buffer = llvm::MemoryBuffer::getFile(input_name, false, false);
+    if (!file_buffer) {
+        diagnostics << "Cannot open the input file." << '\n';
+        return false;
+    }
+    try {
+        SymbolTable symbols;
+        ASTContext context;
+        Lexer<const char *> lexer{(*file_buffer)->getBufferStart(), (*file_buffer)->getBufferEnd(), symbols};
+        auto *program = Parser{TokenStream{lexer, decltype(lexer)()}, context}.parse();
+        if (optimization_level) {
+            ASTOptimizer{context}.optimize(program);
+        }
+
+        ModuleBuilder builder{program, symbols};
+        ModuleProcessor processor{builder.build(), output_name, target};
+        if (processor.verify(diagnostics)) {
+            return false;
+        }
+        if (optimization_level) {
+            processor.optimize(*optimization_level);
+        }
+        return processor.compile(output_kind, diagnostics) == 0;
+    } catch (const std::exception &error) {
+        diagnostics << error.what() << '\n';
+        return false;
+    }
+}
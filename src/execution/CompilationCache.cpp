@@ -0,0 +1,199 @@
+#include "execution/CompilationCache.hpp"
+
+#include "helper/RuntimePath.hpp"
+
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/SHA1.h"
+
+#include <algorithm>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Parts are terminated, so that no two different lists of parts hash the same.
+void add_part(llvm::SHA1 &hasher, const llvm::StringRef part) {
+    hasher.update(part);
+    hasher.update(llvm::StringRef{"", 1});
+}
+
+void add_file_identity(llvm::SHA1 &hasher, const std::string &path) {
+    llvm::sys::fs::file_status status;
+    if (!llvm::sys::fs::status(path, status)) {
+        add_part(hasher, path);
+        add_part(hasher, std::to_string(status.getSize()));
+        add_part(hasher, std::to_string(status.getLastModificationTime().time_since_epoch().count()));
+    }
+}
+
+} // namespace
+
+CompilationCache::CompilationCache(std::filesystem::path directory,
+                                   const std::uintmax_t size_limit,
+                                   const llvm::StringRef source,
+                                   const TargetDescription &target,
+                                   const std::optional<llvm::OptimizationLevel> optimization_level)
+  : directory(std::move(directory))
+  , size_limit(size_limit) {
+    llvm::SHA1 hasher;
+    // A rebuilt compiler or runtime generates different code, without any change of the version.
+    add_file_identity(hasher, llvm::sys::fs::getMainExecutable(nullptr, nullptr));
+    add_file_identity(hasher, RUNTIME_PATH);
+    add_part(hasher, LLVM_VERSION_STRING);
+    add_part(hasher, llvm::sys::getDefaultTargetTriple());
+    if (target.cpu == "native") {
+        add_part(hasher, llvm::sys::getHostCPUName());
+        llvm::StringMap<bool> host_features;
+        if (llvm::sys::getHostCPUFeatures(host_features)) {
+            std::vector<std::string> enabled_features;
+            for (const auto &feature : host_features) {
+                if (feature.second) {
+                    enabled_features.push_back(feature.first().str());
+                }
+            }
+            std::sort(enabled_features.begin(), enabled_features.end());
+            add_part(hasher, llvm::join(enabled_features, ","));
+        }
+    } else {
+        add_part(hasher, target.cpu);
+    }
+    add_part(hasher, target.features);
+    if (optimization_level) {
+        add_part(hasher, std::to_string(optimization_level->getSpeedupLevel()));
+        add_part(hasher, std::to_string(optimization_level->getSizeLevel()));
+    } else {
+        add_part(hasher, "none");
+    }
+    hasher.update(source);
+    key = llvm::toHex(hasher.final(), true);
+}
+
+bool CompilationCache::load_object() {
+    auto entry = get_entry(".o");
+    auto object = llvm::MemoryBuffer::getFile(entry.string());
+    if (!object) {
+        return false;
+    }
+    std::error_code error_code;
+    std::filesystem::last_write_time(entry, std::filesystem::file_time_type::clock::now(), error_code);
+    loaded_object = std::move(*object);
+    return true;
+}
+
+void CompilationCache::notifyObjectCompiled(const llvm::Module *module, const llvm::MemoryBufferRef object) {
+    (void)module;
+    store(get_entry(".o"), object.getBuffer(), false);
+}
+
+std::unique_ptr<llvm::MemoryBuffer> CompilationCache::getObject(const llvm::Module *module) {
+    (void)module;
+    if (!loaded_object) {
+        (void)load_object();
+    }
+    return std::move(loaded_object);
+}
+
+bool CompilationCache::retrieve_executable(const std::filesystem::path &output_file) {
+    auto entry = get_entry(".out");
+    std::error_code error_code;
+    if (!std::filesystem::copy_file(entry, output_file, std::filesystem::copy_options::overwrite_existing, error_code)) {
+        return false;
+    }
+    std::filesystem::last_write_time(entry, std::filesystem::file_time_type::clock::now(), error_code);
+    return true;
+}
+
+void CompilationCache::store_executable(const std::filesystem::path &output_file) {
+    if (auto executable = llvm::MemoryBuffer::getFile(output_file.string())) {
+        store(get_entry(".out"), (*executable)->getBuffer(), true);
+    }
+}
+
+void CompilationCache::print_statistics(llvm::raw_ostream &stream) const {
+    std::uintmax_t size = 0;
+    unsigned int entries = 0;
+    std::error_code error_code;
+    for (const auto &entry : std::filesystem::directory_iterator{directory, error_code}) {
+        if (entry.path().extension() != ".tmp") {
+            size += entry.file_size(error_code);
+            ++entries;
+        }
+    }
+    stream << "Cache " << directory.string() << ": " << hits << " hits, " << misses << " misses, " << evictions
+           << " evictions, " << entries << " entries, " << llvm::format("%.1f", static_cast<double>(size) / 1048576)
+           << " of " << llvm::format("%.1f", static_cast<double>(size_limit) / 1048576) << " MB" << '\n';
+}
+
+std::filesystem::path CompilationCache::get_entry(const char *extension) const {
+    return directory / (key + extension);
+}
+
+void CompilationCache::store(const std::filesystem::path &entry, const llvm::StringRef content, const bool executable) {
+    std::error_code error_code;
+    std::filesystem::create_directories(directory, error_code);
+    int file_descriptor;
+    llvm::SmallString<128> temporary_file;
+    auto permissions = executable ? llvm::sys::fs::all_all : llvm::sys::fs::all_read | llvm::sys::fs::all_write;
+    if (llvm::sys::fs::createUniqueFile((directory / "%%%%%%%%%%%%.tmp").string(),
+                                       file_descriptor,
+                                       temporary_file,
+                                       llvm::sys::fs::OF_None,
+                                       permissions)) {
+        return;
+    }
+    {
+        llvm::raw_fd_ostream stream{file_descriptor, true};
+        stream << content;
+        if (stream.has_error()) {
+            stream.clear_error();
+            llvm::sys::fs::remove(temporary_file);
+            return;
+        }
+    }
+    // Renaming is atomic, so others either find the complete entry or none at all.
+    if (llvm::sys::fs::rename(temporary_file, entry.string())) {
+        llvm::sys::fs::remove(temporary_file);
+        return;
+    }
+    evict();
+}
+
+void CompilationCache::evict() {
+    struct Entry {
+        std::filesystem::path path;
+        std::uintmax_t size;
+        std::filesystem::file_time_type last_use;
+    };
+    std::vector<Entry> entries;
+    std::uintmax_t size = 0;
+    std::error_code error_code;
+    for (const auto &entry : std::filesystem::directory_iterator{directory, error_code}) {
+        // Temporary files belong to the writes in progress.
+        if (entry.path().extension() == ".tmp") {
+            continue;
+        }
+        entries.push_back({entry.path(), entry.file_size(error_code), entry.last_write_time(error_code)});
+        size += entries.back().size;
+    }
+    if (size <= size_limit) {
+        return;
+    }
+    std::sort(entries.begin(), entries.end(), [](const auto &lhs, const auto &rhs) {
+        return lhs.last_use < rhs.last_use;
+    });
+    for (const auto &entry : entries) {
+        if (size <= size_limit) {
+            break;
+        }
+        // Another process may have removed the entry already.
+        if (std::filesystem::remove(entry.path, error_code)) {
+            ++evictions;
+        }
+        size -= entry.size;
+    }
+}
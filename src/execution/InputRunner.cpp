@@ -0,0 +1,77 @@
+#include "execution/InputRunner.hpp"
+
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ThreadPool.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <system_error>
+#include <utility>
+
+InputRunner::InputRunner(const CompiledProgram &program, const std::string &input_directory)
+  : program(program) {
+    std::error_code error_code;
+    for (const auto &entry : std::filesystem::directory_iterator{input_directory, error_code}) {
+        if (entry.is_regular_file()) {
+            input_names.push_back(entry.path().string());
+        }
+    }
+    std::sort(input_names.begin(), input_names.end());
+}
+
+unsigned int InputRunner::run(const unsigned int threads,
+                              const llvm::function_ref<void(const std::string &, llvm::StringRef)> consume,
+                              llvm::raw_ostream &diagnostics) const {
+    struct Run {
+        std::string output;
+        bool readable = false;
+        int status = 0;
+        bool done = false;
+    };
+    std::vector<Run> runs(input_names.size());
+    std::mutex mutex;
+    std::condition_variable run_done;
+
+    llvm::ThreadPool pool{llvm::hardware_concurrency(threads)};
+    for (std::size_t index = 0; index < input_names.size(); ++index) {
+        pool.async([&, index]() {
+            Run run;
+            if (auto input = llvm::MemoryBuffer::getFile(input_names[index], false, false)) {
+                run.readable = true;
+                run.status = program.run((*input)->getBuffer(), run.output);
+            }
+            run.done = true;
+            std::lock_guard lock{mutex};
+            runs[index] = std::move(run);
+            run_done.notify_one();
+        });
+    }
+
+    unsigned int failures = 0;
+    for (std::size_t index = 0; index < runs.size(); ++index) {
+        {
+            std::unique_lock lock{mutex};
+            run_done.wait(lock, [&run = runs[index]]() {
+                return run.done;
+            });
+        }
+        // Finished runs are not touched by the pool anymore.
+        auto &run = runs[index];
+        if (!run.readable) {
+            diagnostics << input_names[index] << ": Cannot open the input file." << '\n';
+            ++failures;
+        } else if (run.status == bitsy_division_error) {
+            diagnostics << input_names[index] << ": The program divided by zero or overflowed in a division." << '\n';
+            ++failures;
+        } else if (run.status != 0) {
+            diagnostics << input_names[index] << ": The program returned " << run.status << "." << '\n';
+            ++failures;
+        }
+        consume(input_names[index], run.output);
+        run.output = {};
+    }
+    pool.wait();
+    return failures;
+}
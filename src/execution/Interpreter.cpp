@@ -0,0 +1,162 @@
+#include "execution/Interpreter.hpp"
+
+#include "runtime/Runtime.hpp"
+
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+// Computed gotos let every instruction jump to its successor directly. Each of these jumps is predicted on its own,
+// which suits the dispatch loop much better than a single shared switch.
+#if defined(__GNUC__)
+#define BITSY_COMPUTED_GOTO 1
+#else
+#define BITSY_COMPUTED_GOTO 0
+#endif
+
+namespace {
+
+// Overflows wrap around like in compiled programs.
+std::int32_t wrapping_add(const std::int32_t lhs, const std::int32_t rhs) {
+    return static_cast<std::int32_t>(static_cast<std::uint32_t>(lhs) + static_cast<std::uint32_t>(rhs));
+}
+
+std::int32_t wrapping_subtract(const std::int32_t lhs, const std::int32_t rhs) {
+    return static_cast<std::int32_t>(static_cast<std::uint32_t>(lhs) - static_cast<std::uint32_t>(rhs));
+}
+
+std::int32_t wrapping_multiply(const std::int32_t lhs, const std::int32_t rhs) {
+    return static_cast<std::int32_t>(static_cast<std::uint32_t>(lhs) * static_cast<std::uint32_t>(rhs));
+}
+
+// Divisions that make the native code trap do the same when interpreted.
+void check_division(const std::int32_t lhs, const std::int32_t rhs) {
+    if (rhs == 0 || (lhs == std::numeric_limits<std::int32_t>::min() && rhs == -1)) {
+        std::raise(SIGFPE);
+        std::abort();
+    }
+}
+
+} // namespace
+
+int Interpreter::execute() const {
+    auto registers = bytecode.registers;
+    auto *value = registers.data();
+    const auto *instruction = bytecode.instructions.data();
+
+#if BITSY_COMPUTED_GOTO
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+    static const void *const instruction_labels[] = {
+        &&add,
+        &&subtract,
+        &&multiply,
+        &&divide,
+        &&remainder,
+        &&move,
+        &&print,
+        &&read,
+        &&jump,
+        &&jump_back,
+        &&jump_unless_zero,
+        &&jump_unless_positive,
+        &&jump_unless_negative,
+        &&halt,
+    };
+    static_assert(std::size(instruction_labels) == static_cast<std::size_t>(Instruction::Opcode::halt) + 1);
+#define INSTRUCTION(opcode) opcode:
+#define DISPATCH() goto *instruction_labels[static_cast<std::size_t>(instruction->opcode)]
+    DISPATCH();
+#else
+#define INSTRUCTION(opcode) case Instruction::Opcode::opcode:
+#define DISPATCH() continue
+    for (;;) {
+        switch (instruction->opcode) {
+#endif
+
+    INSTRUCTION(add) {
+        value[instruction->target] = wrapping_add(value[instruction->lhs], value[instruction->rhs]);
+        ++instruction;
+        DISPATCH();
+    }
+    INSTRUCTION(subtract) {
+        value[instruction->target] = wrapping_subtract(value[instruction->lhs], value[instruction->rhs]);
+        ++instruction;
+        DISPATCH();
+    }
+    INSTRUCTION(multiply) {
+        value[instruction->target] = wrapping_multiply(value[instruction->lhs], value[instruction->rhs]);
+        ++instruction;
+        DISPATCH();
+    }
+    INSTRUCTION(divide) {
+        check_division(value[instruction->lhs], value[instruction->rhs]);
+        value[instruction->target] = value[instruction->lhs] / value[instruction->rhs];
+        ++instruction;
+        DISPATCH();
+    }
+    INSTRUCTION(remainder) {
+        check_division(value[instruction->lhs], value[instruction->rhs]);
+        value[instruction->target] = value[instruction->lhs] % value[instruction->rhs];
+        ++instruction;
+        DISPATCH();
+    }
+    INSTRUCTION(move) {
+        value[instruction->target] = value[instruction->lhs];
+        ++instruction;
+        DISPATCH();
+    }
+    INSTRUCTION(print) {
+        bitsy_print_i32(value[instruction->lhs]);
+        ++instruction;
+        DISPATCH();
+    }
+    INSTRUCTION(read) {
+        value[instruction->target] = bitsy_read_i32(value[instruction->target]);
+        ++instruction;
+        DISPATCH();
+    }
+    INSTRUCTION(jump) {
+        instruction = &bytecode.instructions[instruction->target];
+        DISPATCH();
+    }
+    INSTRUCTION(jump_back) {
+        if (resume_function) {
+            // Variables are the first registers, just where the compiled program expects them.
+            if (auto resume = resume_function->load(std::memory_order_acquire)) {
+                return resume(value, instruction->lhs);
+            }
+        }
+        instruction = &bytecode.instructions[instruction->target];
+        DISPATCH();
+    }
+    INSTRUCTION(jump_unless_zero) {
+        instruction = value[instruction->lhs] == 0 ? instruction + 1 : &bytecode.instructions[instruction->target];
+        DISPATCH();
+    }
+    INSTRUCTION(jump_unless_positive) {
+        instruction = value[instruction->lhs] > 0 ? instruction + 1 : &bytecode.instructions[instruction->target];
+        DISPATCH();
+    }
+    INSTRUCTION(jump_unless_negative) {
+        instruction = value[instruction->lhs] < 0 ? instruction + 1 : &bytecode.instructions[instruction->target];
+        DISPATCH();
+    }
+    INSTRUCTION(halt) {
+        bitsy_flush();
+        return 0;
+    }
+
+#if BITSY_COMPUTED_GOTO
+#pragma GCC diagnostic pop
+#else
+        }
+    }
+#endif
+#undef DISPATCH
+#undef INSTRUCTION
+}
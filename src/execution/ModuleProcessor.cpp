@@ -1,39 +1,133 @@
 #include "execution/ModuleProcessor.hpp"
 
 #include "helper/ClangPath.hpp"
+#include "helper/RuntimePath.hpp"
+#include "runtime/Runtime.hpp"
 
+// Once the ORC headers use LLVM's format providers, GCC takes one of their variables for uninitialized, which it is
+// not. The warning points into the headers, so it is only silenced there.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
 #include "llvm/Analysis/CFGPrinter.h"
+#include "llvm/Analysis/CGSCCPassManager.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Analysis/LoopAnalysisManager.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
-#include "llvm/ExecutionEngine/GenericValue.h"
 #include "llvm/ExecutionEngine/MCJIT.h" // IWYU pragma: keep // Forces MCJIT to be linked in.
+#include "llvm/ExecutionEngine/Orc/CompileUtils.h"
+#include "llvm/ExecutionEngine/Orc/Core.h"
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/PassManager.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/MC/SubtargetFeature.h"
+#include "llvm/MC/TargetRegistry.h"
 #include "llvm/Passes/PassBuilder.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
 #include "llvm/Support/GraphWriter.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/TargetSelect.h"
-#include "llvm/Transforms//Scalar/SimplifyCFG.h"
-#include "llvm/Transforms//Utils/Mem2Reg.h"
-#include "llvm/Transforms/Scalar/Reassociate.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Transforms/Utils/Cloning.h"
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
 
+#include <cstdint>
 #include <filesystem>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string get_features(const TargetDescription &target) {
+    llvm::SubtargetFeatures features;
+    if (target.cpu == "native") {
+        llvm::StringMap<bool> host_features;
+        if (llvm::sys::getHostCPUFeatures(host_features)) {
+            for (const auto &feature : host_features) {
+                features.AddFeature(feature.first(), feature.second);
+            }
+        }
+    }
+    // Later features take precedence over earlier ones.
+    llvm::SmallVector<llvm::StringRef, 8> requested_features;
+    llvm::StringRef{target.features}.split(requested_features, ',', -1, false);
+    for (auto feature : requested_features) {
+        features.AddFeature(feature.trim());
+    }
+    return features.getString();
+}
+
+} // namespace
+
+bool TargetDescription::is_supported() const {
+    if (cpu == "native") {
+        return true;
+    }
+    llvm::InitializeNativeTarget();
 
-const static auto tmp_dir = std::filesystem::temp_directory_path() / "bitsyc";
-const static auto ll_file = tmp_dir / "tmp.ll";
-const static auto dot_file = tmp_dir / "tmp.dot";
+    std::string error;
+    const auto triple = llvm::sys::getDefaultTargetTriple();
+    const auto *target = llvm::TargetRegistry::lookupTarget(triple, error);
+    if (!target) {
+        return false;
+    }
+    std::unique_ptr<llvm::MCSubtargetInfo> subtarget{target->createMCSubtargetInfo(triple, "", "")};
+    return subtarget && subtarget->isCPUStringValid(cpu);
+}
+
+ModuleProcessor::ModuleProcessor(llvm::orc::ThreadSafeModule module,
+                                 std::string output_name,
+                                 const TargetDescription &target)
+  : module(std::move(module))
+  , output_name(std::move(output_name))
+  , cpu(target.cpu == "native" ? llvm::sys::getHostCPUName().str() : target.cpu)
+  , features(get_features(target))
+  , target_machine(create_target_machine()) {
+    if (target_machine) {
+        this->module.getModuleUnlocked()->setDataLayout(target_machine->createDataLayout());
+    }
+    // The functions carry the target along, even into bitcode files.
+    for (auto &function : *this->module.getModuleUnlocked()) {
+        if (function.isDeclaration()) {
+            continue;
+        }
+        function.addFnAttr("target-cpu", cpu);
+        if (!features.empty()) {
+            function.addFnAttr("target-features", features);
+        }
+    }
+}
 
 void ModuleProcessor::print() const {
-    module->print(llvm::outs(), nullptr);
+    module.getModuleUnlocked()->print(llvm::outs(), nullptr);
 }
 
-bool ModuleProcessor::show_cfg() const {
-    std::filesystem::create_directory(tmp_dir);
+unsigned int ModuleProcessor::get_instruction_count() const {
+    return module.getModuleUnlocked()->getInstructionCount();
+}
 
-    llvm::DOTFuncInfo cfg_info{module->getFunction("main")};
-    llvm::WriteGraph(&cfg_info, "", false, "", dot_file);
+bool ModuleProcessor::show_cfg() const {
+    // Every process gets its own file, so that several of them can run at once.
+    llvm::SmallString<128> dot_file;
+    if (llvm::sys::fs::createTemporaryFile("bitsyc", "dot", dot_file)) {
+        std::cerr << "Error creating temporary file for DOT output." << '\n';
+        return false;
+    }
+    llvm::FileRemover dot_file_remover{dot_file};
+    llvm::DOTFuncInfo cfg_info{module.getModuleUnlocked()->getFunction("main")};
+    llvm::WriteGraph(&cfg_info, "", false, "", dot_file.str().str());
 
     auto dot_program = llvm::sys::findProgramByName("dot");
     if (!dot_program) {
@@ -41,7 +135,7 @@ bool ModuleProcessor::show_cfg() const {
         return false;
     }
     auto png_file = std::filesystem::current_path() / (output_name + ".png");
-    llvm::ArrayRef<llvm::StringRef> dot_arguments{*dot_program, "-Tpng", "-o", png_file.c_str(), dot_file.c_str()};
+    llvm::ArrayRef<llvm::StringRef> dot_arguments{*dot_program, "-Tpng", "-o", png_file.c_str(), dot_file};
     if (llvm::sys::ExecuteAndWait(*dot_program, dot_arguments) != 0) {
         std::cerr << "Error converting DOT file to PNG file." << '\n';
         return false;
@@ -61,59 +155,255 @@ bool ModuleProcessor::show_cfg() const {
     return true;
 }
 
-bool ModuleProcessor::verify() const {
-    return llvm::verifyModule(*module, &llvm::outs());
+bool ModuleProcessor::verify(llvm::raw_ostream &diagnostics) const {
+    return llvm::verifyModule(*module.getModuleUnlocked(), &diagnostics);
 }
 
-void ModuleProcessor::optimize() {
-    llvm::FunctionPassManager pass_manager{};
-    // TODO: Investigate why the commented passes lead to segmentation faults.
-    pass_manager.addPass(llvm::ReassociatePass());
-    // pass_manager.addPass(llvm::GVNPass());
-    pass_manager.addPass(llvm::SimplifyCFGPass());
-    // pass_manager.addPass(llvm::InstCombinePass());
-    pass_manager.addPass(llvm::PromotePass());
+void ModuleProcessor::optimize(const llvm::OptimizationLevel level) {
+    // Passes reach the analyses of other IR units through proxies, so all analysis managers have to know each other.
+    llvm::LoopAnalysisManager loop_analysis_manager;
+    llvm::FunctionAnalysisManager function_analysis_manager;
+    llvm::CGSCCAnalysisManager cgscc_analysis_manager;
+    llvm::ModuleAnalysisManager module_analysis_manager;
 
-    llvm::PassBuilder pass_builder;
-    llvm::FunctionAnalysisManager analysis_manager{};
-    pass_builder.registerFunctionAnalyses(analysis_manager);
+    // The target machine tells passes like the loop vectorizer what the hardware is capable of.
+    llvm::PassBuilder pass_builder{target_machine.get()};
+    pass_builder.registerModuleAnalyses(module_analysis_manager);
+    pass_builder.registerCGSCCAnalyses(cgscc_analysis_manager);
+    pass_builder.registerFunctionAnalyses(function_analysis_manager);
+    pass_builder.registerLoopAnalyses(loop_analysis_manager);
+    pass_builder.crossRegisterProxies(loop_analysis_manager,
+                                      function_analysis_manager,
+                                      cgscc_analysis_manager,
+                                      module_analysis_manager);
 
-    pass_manager.run(*module->getFunction("main"), analysis_manager);
+    auto pass_manager = level == llvm::OptimizationLevel::O0 ? pass_builder.buildO0DefaultPipeline(level)
+                                                             : pass_builder.buildPerModuleDefaultPipeline(level);
+    pass_manager.run(*module.getModuleUnlocked(), module_analysis_manager);
+    optimization_level = level;
 }
 
-int ModuleProcessor::compile() const {
-    std::filesystem::create_directory(tmp_dir);
-
+int ModuleProcessor::compile(const OutputKind kind, llvm::raw_ostream &diagnostics) const {
+    auto out_file = (std::filesystem::current_path() / output_name).string();
     std::error_code error_code;
-    llvm::raw_fd_ostream file_stream{ll_file.string(), error_code};
+    switch (kind) {
+        case OutputKind::bitcode: {
+            llvm::raw_fd_ostream file_stream{out_file, error_code};
+            if (error_code.value() != 0) {
+                diagnostics << "Error creating the output file." << '\n';
+                return error_code.value();
+            }
+            llvm::WriteBitcodeToFile(*module.getModuleUnlocked(), file_stream);
+            return 0;
+        }
+        case OutputKind::object:
+        case OutputKind::assembly: {
+            llvm::raw_fd_ostream file_stream{out_file, error_code};
+            if (error_code.value() != 0) {
+                diagnostics << "Error creating the output file." << '\n';
+                return error_code.value();
+            }
+            return emit(file_stream,
+                        kind == OutputKind::object ? llvm::CGFT_ObjectFile : llvm::CGFT_AssemblyFile,
+                        diagnostics)
+                       ? 0
+                       : 1;
+        }
+        case OutputKind::executable:
+            break;
+    }
+
+    // The object file is only an intermediate step. Clang merely links it with the runtime.
+    int object_fd;
+    llvm::SmallString<128> object_file;
+    error_code = llvm::sys::fs::createTemporaryFile("bitsyc", "o", object_fd, object_file);
+    if (error_code.value() != 0) {
+        diagnostics << "Error creating temporary file for object output." << '\n';
+        return error_code.value();
+    }
+    llvm::FileRemover object_file_remover{object_file};
+    {
+        llvm::raw_fd_ostream file_stream{object_fd, true};
+        if (!emit(file_stream, llvm::CGFT_ObjectFile, diagnostics)) {
+            return 1;
+        }
+    }
+
+    // The messages of the linker belong to the diagnostics of this module.
+    llvm::SmallString<128> linker_output_file;
+    error_code = llvm::sys::fs::createTemporaryFile("bitsyc", "txt", linker_output_file);
     if (error_code.value() != 0) {
-        std::cerr << "Error creating temporary file for IR output." << '\n';
+        diagnostics << "Error creating temporary file for linker output." << '\n';
         return error_code.value();
     }
-    module->print(file_stream, nullptr);
-
-    auto out_file = std::filesystem::current_path() / output_name;
-    std::vector<llvm::StringRef> arguments{
-        CLANG_PATH,
-        ll_file.c_str(),
-        "-o",
-        out_file.c_str(),
-        "-Wno-override-module" // For whatever reason the target triple returned by
-                               // 'llvm::sys::getDefaultTargetTriple()' is not the one Clang
-                               // actually expects on macOS. This option
-                               // suppresses the warning.
+    llvm::FileRemover linker_output_file_remover{linker_output_file};
+    std::vector<llvm::StringRef> arguments{CLANG_PATH, object_file, RUNTIME_PATH, "-o", out_file};
+    std::vector<llvm::Optional<llvm::StringRef>> redirects{llvm::None, llvm::None, linker_output_file.str()};
+    std::string error_message;
+    auto result = llvm::sys::ExecuteAndWait(CLANG_PATH, arguments, llvm::None, redirects, 0, 0, &error_message);
+    if (auto linker_output = llvm::MemoryBuffer::getFile(linker_output_file)) {
+        diagnostics << (*linker_output)->getBuffer();
+    }
+    if (!error_message.empty()) {
+        diagnostics << error_message << '\n';
+    }
+    return result;
+}
+
+std::unique_ptr<llvm::orc::LLLazyJIT> ModuleProcessor::create_jit() {
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+
+    llvm::orc::JITTargetMachineBuilder target_machine_builder{
+        llvm::Triple{module.getModuleUnlocked()->getTargetTriple()}};
+    llvm::SmallVector<llvm::StringRef, 32> attributes;
+    llvm::StringRef{features}.split(attributes, ',', -1, false);
+    target_machine_builder.setCPU(cpu)
+        .addFeatures({attributes.begin(), attributes.end()})
+        .setCodeGenOptLevel(get_codegen_optimization_level());
+
+    // Compiling on other threads lets lazily compiled functions be prepared concurrently. With a single core, the
+    // hand-over to another thread would only add to the startup.
+    auto compile_threads = llvm::hardware_concurrency().compute_thread_count();
+    using Compiler = llvm::orc::IRCompileLayer::IRCompiler;
+    auto create_compiler = [cache = object_cache](
+                               llvm::orc::JITTargetMachineBuilder builder) -> llvm::Expected<std::unique_ptr<Compiler>> {
+        return std::make_unique<llvm::orc::ConcurrentIRCompiler>(std::move(builder), cache);
     };
-    return llvm::sys::ExecuteAndWait(CLANG_PATH, arguments);
+    auto jit = llvm::orc::LLLazyJITBuilder{}
+                   .setJITTargetMachineBuilder(std::move(target_machine_builder))
+                   .setNumCompileThreads(compile_threads > 1 ? compile_threads : 0)
+                   .setCompileFunctionCreator(create_compiler)
+                   .create();
+    if (!jit) {
+        llvm::logAllUnhandledErrors(jit.takeError(), llvm::errs(), "Cannot create the JIT compiler: ");
+        return nullptr;
+    }
+
+    // The runtime is part of this process already.
+    auto &main_library = (*jit)->getMainJITDylib();
+    auto error = main_library.define(llvm::orc::absoluteSymbols({
+        {(*jit)->mangleAndIntern("bitsy_print_i32"), llvm::JITEvaluatedSymbol::fromPointer(&bitsy_print_i32)},
+        {(*jit)->mangleAndIntern("bitsy_read_i32"), llvm::JITEvaluatedSymbol::fromPointer(&bitsy_read_i32)},
+        {(*jit)->mangleAndIntern("bitsy_flush"), llvm::JITEvaluatedSymbol::fromPointer(&bitsy_flush)},
+    }));
+    if (error) {
+        llvm::logAllUnhandledErrors(std::move(error), llvm::errs(), "Cannot provide the runtime: ");
+        return nullptr;
+    }
+
+    // The cache holds the object file of the whole module. Otherwise, functions are only compiled once they are
+    // called for the first time, which pays off as soon as there are several of them.
+    std::unique_ptr<llvm::MemoryBuffer> cached_object;
+    if (object_cache) {
+        cached_object = object_cache->getObject(module.getModuleUnlocked());
+    }
+    auto function_count = llvm::count_if(*module.getModuleUnlocked(), [](const auto &function) {
+        return !function.isDeclaration();
+    });
+    if (cached_object) {
+        error = (*jit)->addObjectFile(std::move(cached_object));
+    } else if (object_cache || function_count <= 1) {
+        error = (*jit)->addIRModule(std::move(module));
+    } else {
+        error = (*jit)->addLazyIRModule(std::move(module));
+    }
+    if (error) {
+        llvm::logAllUnhandledErrors(std::move(error), llvm::errs(), "Cannot add the program to the JIT compiler: ");
+        return nullptr;
+    }
+    return std::move(*jit);
+}
+
+llvm::Expected<int (*)()> ModuleProcessor::find_main(llvm::orc::LLLazyJIT &jit) {
+    auto main_symbol = jit.lookup("main");
+    if (!main_symbol) {
+        return main_symbol.takeError();
+    }
+#if LLVM_VERSION_MAJOR < 15
+    return reinterpret_cast<int (*)()>(main_symbol->getAddress());
+#else
+    return main_symbol->toPtr<int (*)()>();
+#endif
+}
+
+int ModuleProcessor::execute() {
+    auto jit = create_jit();
+    if (!jit) {
+        return 1;
+    }
+    auto main_function = find_main(*jit);
+    if (!main_function) {
+        llvm::logAllUnhandledErrors(main_function.takeError(), llvm::errs(), "Cannot compile the program: ");
+        return 1;
+    }
+    return (*main_function)(); // Programs always return 0.
 }
 
-int ModuleProcessor::execute() const {
+std::unique_ptr<llvm::ExecutionEngine> ModuleProcessor::create_engine() const {
     llvm::InitializeNativeTarget();
     llvm::InitializeNativeTargetAsmPrinter();
 
-    auto engine_module = llvm::CloneModule(*module);
-    auto main = engine_module->getFunction("main");
-    auto engine = llvm::EngineBuilder(std::move(engine_module)).create();
-    auto result = engine->runFunction(main, {});
+    llvm::SmallVector<llvm::StringRef, 32> attributes;
+    llvm::StringRef{features}.split(attributes, ',', -1, false);
+    std::unique_ptr<llvm::ExecutionEngine> engine{llvm::EngineBuilder(llvm::CloneModule(*module.getModuleUnlocked()))
+                                                      .setOptLevel(get_codegen_optimization_level())
+                                                      .setMCPU(cpu)
+                                                      .setMAttrs(attributes)
+                                                      .create()};
+    // The runtime is part of this process already.
+    engine->addGlobalMapping("bitsy_print_i32", reinterpret_cast<std::uintptr_t>(&bitsy_print_i32));
+    engine->addGlobalMapping("bitsy_read_i32", reinterpret_cast<std::uintptr_t>(&bitsy_read_i32));
+    engine->addGlobalMapping("bitsy_flush", reinterpret_cast<std::uintptr_t>(&bitsy_flush));
+    return engine;
+}
+
+std::unique_ptr<llvm::TargetMachine> ModuleProcessor::create_target_machine() const {
+    llvm::InitializeNativeTarget();
 
-    return static_cast<int>(result.IntVal.getSExtValue()); // Programs always return 0.
+    std::string error;
+    const auto &triple = module.getModuleUnlocked()->getTargetTriple();
+    const auto *target = llvm::TargetRegistry::lookupTarget(triple, error);
+    if (!target) {
+        return nullptr;
+    }
+    return std::unique_ptr<llvm::TargetMachine>(
+        target->createTargetMachine(triple, cpu, features, llvm::TargetOptions{}, llvm::Reloc::PIC_));
+}
+
+bool ModuleProcessor::emit(llvm::raw_pwrite_stream &stream,
+                           const llvm::CodeGenFileType file_type,
+                           llvm::raw_ostream &diagnostics) const {
+    if (!target_machine) {
+        diagnostics << "The target of the module is not supported." << '\n';
+        return false;
+    }
+    llvm::InitializeNativeTargetAsmPrinter();
+    target_machine->setOptLevel(get_codegen_optimization_level());
+
+    // Code generation adapts the IR it works on, while the module should stay as it is for execution.
+    auto module_copy = llvm::CloneModule(*module.getModuleUnlocked());
+    llvm::legacy::PassManager pass_manager;
+    if (target_machine->addPassesToEmitFile(pass_manager, stream, nullptr, file_type)) {
+        diagnostics << "The target cannot emit this kind of file." << '\n';
+        return false;
+    }
+    pass_manager.run(*module_copy);
+    return true;
+}
+
+llvm::CodeGenOpt::Level ModuleProcessor::get_codegen_optimization_level() const {
+    if (!optimization_level) {
+        return llvm::CodeGenOpt::Default;
+    }
+    switch (optimization_level->getSpeedupLevel()) {
+        case 0:
+            return llvm::CodeGenOpt::None;
+        case 1:
+            return llvm::CodeGenOpt::Less;
+        case 2:
+            return llvm::CodeGenOpt::Default;
+        default:
+            return llvm::CodeGenOpt::Aggressive;
+    }
 }
@@ -0,0 +1,41 @@
+#include "execution/TieredExecutor.hpp"
+
+#include <cstdint>
+#include <utility>
+
+TieredExecutor::TieredExecutor(const Bytecode &bytecode,
+                               const ModuleBuilder &builder,
+                               const std::optional<llvm::OptimizationLevel> optimization_level,
+                               TargetDescription target)
+  : bytecode(bytecode)
+  , builder(builder)
+  , optimization_level(optimization_level)
+  , target(std::move(target))
+  , resume_function(nullptr) {}
+
+TieredExecutor::~TieredExecutor() {
+    if (compiler.joinable()) {
+        compiler.join();
+    }
+}
+
+int TieredExecutor::execute() {
+    compiler = std::thread([this]() {
+        compile();
+    });
+    return Interpreter{bytecode, resume_function}.execute();
+}
+
+void TieredExecutor::compile() {
+    ModuleProcessor processor{builder.build(), "", target};
+    if (processor.verify()) {
+        return;
+    }
+    if (optimization_level) {
+        processor.optimize(*optimization_level);
+    }
+    engine = processor.create_engine();
+    auto address = engine->getFunctionAddress("main");
+    resume_function.store(reinterpret_cast<ResumeFunction>(static_cast<std::uintptr_t>(address)),
+                          std::memory_order_release);
+}
@@ -0,0 +1,125 @@
+#include "helper/PhaseProfile.hpp"
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/JSON.h"
+
+#include <iterator>
+
+#include <malloc.h>
+#include <sys/resource.h>
+
+namespace {
+
+// Large blocks are mapped separately and are only part of the heap statistics as such.
+std::size_t get_heap_bytes() {
+    auto info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+std::uint64_t get_peak_memory_bytes() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    // Linux reports kilobytes.
+    return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+}
+
+} // namespace
+
+PhaseProfile::Scope::Scope(PhaseProfile *profile, const std::size_t phase_index)
+  : profile(profile)
+  , phase_index(phase_index)
+  , start_heap_bytes(get_heap_bytes()) {
+    profile->phases[phase_index].timer->startTimer();
+}
+
+PhaseProfile::Scope::~Scope() {
+    if (!profile) {
+        return;
+    }
+    auto &phase = profile->phases[phase_index];
+    phase.timer->stopTimer();
+    phase.heap_delta_bytes +=
+        static_cast<std::int64_t>(get_heap_bytes()) - static_cast<std::int64_t>(start_heap_bytes);
+    phase.peak_memory_bytes = get_peak_memory_bytes();
+}
+
+PhaseProfile::~PhaseProfile() {
+    timer_group.clear();
+}
+
+PhaseProfile::Scope PhaseProfile::measure(const llvm::StringRef phase) {
+    auto existing_phase = llvm::find_if(phases, [phase](const auto &other) {
+        return other.name == phase;
+    });
+    if (existing_phase == phases.end()) {
+        phases.push_back({phase.str(), std::make_unique<llvm::Timer>(phase, phase, timer_group)});
+        existing_phase = std::prev(phases.end());
+    }
+    return {this, static_cast<std::size_t>(existing_phase - phases.begin())};
+}
+
+void PhaseProfile::count(const llvm::StringRef counter, const std::uint64_t value) {
+    auto existing_counter = llvm::find_if(counters, [counter](const auto &other) {
+        return other.first == counter;
+    });
+    if (existing_counter == counters.end()) {
+        counters.emplace_back(counter.str(), value);
+    } else {
+        existing_counter->second += value;
+    }
+}
+
+void PhaseProfile::print(llvm::raw_ostream &stream) const {
+    stream << llvm::left_justify("phase", 28) << llvm::right_justify("wall ms", 11)
+           << llvm::right_justify("user ms", 11) << llvm::right_justify("system ms", 11)
+           << llvm::right_justify("heap delta KB", 15) << llvm::right_justify("peak KB", 15) << '\n';
+    llvm::TimeRecord total;
+    for (const auto &phase : phases) {
+        auto time = phase.timer->getTotalTime();
+        total += time;
+        stream << llvm::format("%-28s %10.3f %10.3f %10.3f %14.1f %14.1f\n",
+                               phase.name.c_str(),
+                               time.getWallTime() * 1000,
+                               time.getUserTime() * 1000,
+                               time.getSystemTime() * 1000,
+                               static_cast<double>(phase.heap_delta_bytes) / 1024,
+                               static_cast<double>(phase.peak_memory_bytes) / 1024);
+    }
+    stream << llvm::left_justify("total", 28)
+           << llvm::format(" %10.3f %10.3f %10.3f\n",
+                           total.getWallTime() * 1000,
+                           total.getUserTime() * 1000,
+                           total.getSystemTime() * 1000);
+    if (!counters.empty()) {
+        stream << '\n' << llvm::left_justify("counter", 28) << llvm::right_justify("value", 11) << '\n';
+    }
+    for (const auto &[name, value] : counters) {
+        stream << llvm::format("%-28s %10llu\n", name.c_str(), static_cast<unsigned long long>(value));
+    }
+}
+
+void PhaseProfile::print_json(llvm::raw_ostream &stream) const {
+    llvm::json::OStream json{stream, 2};
+    json.object([&]() {
+        json.attributeArray("phases", [&]() {
+            for (const auto &phase : phases) {
+                auto time = phase.timer->getTotalTime();
+                json.object([&]() {
+                    json.attribute("name", phase.name);
+                    json.attribute("wall_seconds", time.getWallTime());
+                    json.attribute("user_seconds", time.getUserTime());
+                    json.attribute("system_seconds", time.getSystemTime());
+                    json.attribute("heap_delta_bytes", phase.heap_delta_bytes);
+                    json.attribute("peak_memory_bytes", static_cast<std::int64_t>(phase.peak_memory_bytes));
+                });
+            }
+        });
+        json.attributeObject("counters", [&]() {
+            for (const auto &[name, value] : counters) {
+                json.attribute(name, static_cast<std::int64_t>(value));
+            }
+        });
+    });
+    stream << '\n';
+}
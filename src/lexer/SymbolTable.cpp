@@ -0,0 +1,10 @@
+#include "lexer/SymbolTable.hpp"
+
+SymbolID SymbolTable::intern(const llvm::StringRef name) {
+    auto [entry, inserted] = ids.try_emplace(name, static_cast<SymbolID>(names.size()));
+    if (inserted) {
+        // The keys of a 'StringMap' do not move on rehashing, so the names can refer to them.
+        names.push_back(entry->getKey());
+    }
+    return entry->getValue();
+}
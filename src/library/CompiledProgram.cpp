@@ -0,0 +1,97 @@
+#include "library/CompiledProgram.hpp"
+
+#include "ast/ASTContext.hpp"
+#include "ast/ASTOptimizer.hpp"
+#include "codegen/ModuleBuilder.hpp"
+#include "lexer/Lexer.hpp"
+#include "lexer/SymbolTable.hpp"
+#include "parser/Parser.hpp"
+#include "parser/TokenStream.hpp"
+
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstddef>
+#include <stdexcept>
+
+CompiledProgram::CompiledProgram(const llvm::StringRef source, const CompileOptions &options) {
+    if (!options.target.is_supported()) {
+        throw std::logic_error("Unknown processor '" + options.target.cpu + "'.");
+    }
+
+    // Neither the source nor the AST are needed once the module is built.
+    SymbolTable symbols;
+    ASTContext context;
+    Lexer<const char *> lexer{source.begin(), source.end(), symbols};
+    auto *program = Parser{TokenStream{lexer, decltype(lexer)()}, context}.parse();
+    if (options.optimization_level) {
+        ASTOptimizer{context}.optimize(program);
+    }
+    // A trap in a run would end the embedding process, so invalid divisions return an exit status instead.
+    ModuleBuilder builder{program, symbols, false, true};
+    ModuleProcessor processor{builder.build(), "", options.target};
+    std::string diagnostics;
+    llvm::raw_string_ostream diagnostics_stream{diagnostics};
+    if (processor.verify(diagnostics_stream)) {
+        throw std::logic_error("Generated invalid code: " + diagnostics_stream.str());
+    }
+    if (options.optimization_level) {
+        processor.optimize(*options.optimization_level);
+    }
+
+    jit = processor.create_jit();
+    if (!jit) {
+        throw std::logic_error("Cannot create the JIT compiler.");
+    }
+    auto found_main = ModuleProcessor::find_main(*jit);
+    if (!found_main) {
+        throw std::logic_error("Cannot compile the program: " + llvm::toString(found_main.takeError()));
+    }
+    main_function = *found_main;
+}
+
+CompiledProgram::CompiledProgram(CompiledProgram &&) noexcept = default;
+
+CompiledProgram &CompiledProgram::operator=(CompiledProgram &&) noexcept = default;
+
+CompiledProgram::~CompiledProgram() = default;
+
+int CompiledProgram::run(const llvm::function_ref<llvm::StringRef()> read,
+                         const llvm::function_ref<void(llvm::StringRef)> write) const {
+    struct Callbacks {
+        llvm::function_ref<llvm::StringRef()> read;
+        llvm::function_ref<void(llvm::StringRef)> write;
+    } callbacks{read, write};
+    const BitsyIO io{
+        &callbacks,
+        [](void *context, const char **chunk) -> std::size_t {
+            auto data = static_cast<Callbacks *>(context)->read();
+            *chunk = data.data();
+            return data.size();
+        },
+        [](void *context, const char *data, const std::size_t size) {
+            static_cast<Callbacks *>(context)->write({data, size});
+        },
+    };
+    return run(io);
+}
+
+int CompiledProgram::run(llvm::StringRef input, std::string &output) const {
+    return run(
+        [&input]() {
+            auto chunk = input;
+            input = {};
+            return chunk;
+        },
+        [&output](const llvm::StringRef data) {
+            output.append(data.data(), data.size());
+        });
+}
+
+int CompiledProgram::run(const BitsyIO &io) const {
+    const auto *previous_io = bitsy_set_io(&io);
+    auto result = main_function();
+    bitsy_set_io(previous_io);
+    return result;
+}
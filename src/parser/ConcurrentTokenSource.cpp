@@ -0,0 +1,117 @@
+#include "parser/ConcurrentTokenSource.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class ConcurrentTokenSource::Queue {
+    static constexpr std::size_t batch_size = 512;
+    static constexpr std::size_t max_batches = 8;
+
+    using Batch = std::vector<Token>;
+
+    TokenStream::TokenSource source;
+
+    std::mutex mutex;
+    std::condition_variable batch_consumed;
+    std::condition_variable batch_produced;
+    std::deque<Batch> batches;
+    bool finished = false;
+    bool cancelled = false;
+    std::exception_ptr error;
+
+    Batch current_batch;
+    std::size_t current_index = 0;
+
+    std::thread producer;
+
+  public:
+    explicit Queue(TokenStream::TokenSource source)
+      : source(std::move(source))
+      , producer([this]() {
+          produce();
+      }) {}
+
+    Queue(const Queue &) = delete;
+    Queue &operator=(const Queue &) = delete;
+
+    ~Queue() {
+        {
+            std::lock_guard lock{mutex};
+            cancelled = true;
+        }
+        batch_consumed.notify_one();
+        producer.join();
+    }
+
+    std::optional<Token> pop() {
+        if (current_index == current_batch.size()) {
+            std::unique_lock lock{mutex};
+            batch_produced.wait(lock, [this]() {
+                return !batches.empty() || finished;
+            });
+            if (batches.empty()) {
+                if (error) {
+                    std::rethrow_exception(std::exchange(error, nullptr));
+                }
+                return {};
+            }
+            current_batch = std::move(batches.front());
+            current_index = 0;
+            batches.pop_front();
+            lock.unlock();
+            batch_consumed.notify_one();
+        }
+        return current_batch[current_index++];
+    }
+
+  private:
+    void produce() {
+        Batch batch;
+        try {
+            while (auto token = source()) {
+                batch.push_back(*token);
+                if (batch.size() == batch_size && !push(std::exchange(batch, {}))) {
+                    return;
+                }
+            }
+        } catch (...) {
+            std::lock_guard lock{mutex};
+            error = std::current_exception();
+        }
+        if (!batch.empty() && !push(std::move(batch))) {
+            return;
+        }
+        {
+            std::lock_guard lock{mutex};
+            finished = true;
+        }
+        batch_produced.notify_one();
+    }
+
+    bool push(Batch batch) {
+        {
+            std::unique_lock lock{mutex};
+            batch_consumed.wait(lock, [this]() {
+                return batches.size() < max_batches || cancelled;
+            });
+            if (cancelled) {
+                return false;
+            }
+            batches.push_back(std::move(batch));
+        }
+        batch_produced.notify_one();
+        return true;
+    }
+};
+
+ConcurrentTokenSource::ConcurrentTokenSource(TokenStream::TokenSource source)
+  : queue(std::make_shared<Queue>(std::move(source))) {}
+
+std::optional<Token> ConcurrentTokenSource::operator()() {
+    return queue->pop();
+}
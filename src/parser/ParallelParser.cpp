@@ -0,0 +1,290 @@
+#include "parser/ParallelParser.hpp"
+
+#include "lexer/Lexer.hpp"
+#include "parser/Parser.hpp"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Casting.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+
+#include <algorithm>
+#include <optional>
+
+ParallelParser::ParallelParser(const char *begin,
+                               const char *end,
+                               SymbolTable &symbols,
+                               ASTContext &context,
+                               const unsigned int threads)
+  : characters_begin(begin)
+  , characters_end(end)
+  , symbols(symbols)
+  , context(context)
+  , thread_count(std::max(threads, 1U)) {}
+
+Program *ParallelParser::parse() {
+    llvm::ThreadPool pool{llvm::hardware_concurrency(thread_count)};
+    auto statement_starts = scan_statement_starts(pool);
+    if (statement_starts.empty()) {
+        return parse_sequentially();
+    }
+    auto ranges = split(statement_starts);
+
+    for (auto &range : ranges) {
+        pool.async([&range]() {
+            parse_range(range);
+        });
+    }
+    pool.wait();
+    if (std::any_of(ranges.begin(), ranges.end(), [](const Range &range) {
+            return range.block == nullptr;
+        })) {
+        return parse_sequentially();
+    }
+
+    // Names are interned in the order the sequential parser would have seen them first.
+    for (auto &range : ranges) {
+        std::vector<SymbolID> new_symbols(range.symbols.size());
+        for (SymbolID symbol = 0; symbol < new_symbols.size(); ++symbol) {
+            new_symbols[symbol] = symbols.intern(range.symbols.get_name(symbol));
+        }
+        pool.async([&range, new_symbols = std::move(new_symbols)]() {
+            relabel_symbols(range.block, new_symbols);
+        });
+    }
+    pool.wait();
+
+    // The sequential lexer has already looked at the token after the final 'END' when the parser stops.
+    Lexer<const char *> trailing_lexer{statement_starts.back(), characters_end, symbols};
+    ++trailing_lexer;
+
+    llvm::SmallVector<Statement *, 64> statements;
+    for (const auto &range : ranges) {
+        statements.append(range.block->statements.begin(), range.block->statements.end());
+    }
+    return context.create<Program>(context.create<Block>(context.copy<Statement *>(statements)));
+}
+
+std::vector<const char *> ParallelParser::scan_statement_starts(llvm::ThreadPool &pool) const {
+    auto chunk_boundaries = split_into_chunks();
+    std::vector<ScannedChunk> chunks(chunk_boundaries.size() - 1);
+    for (std::size_t chunk = 0; chunk < chunks.size(); ++chunk) {
+        pool.async([&, chunk]() {
+            chunks[chunk] = scan_chunk(chunk_boundaries[chunk], chunk_boundaries[chunk + 1]);
+        });
+    }
+    pool.wait();
+
+    // The first range starts right after 'BEGIN', the last one at the final 'END'. Anything unexpected leaves the
+    // error reporting to the sequential parser.
+    std::vector<const char *> statement_starts;
+    std::size_t depth = 0;
+    const char *trailing_variable = nullptr;
+    for (const auto &chunk : chunks) {
+        if (!chunk.valid) {
+            return {};
+        }
+        if (chunk.first_token_type) {
+            if (statement_starts.empty() && chunk.first_token_type != TokenType::begin_t) {
+                return {};
+            }
+            if (chunk.starts_with_assignment && trailing_variable && depth == 1) {
+                statement_starts.push_back(trailing_variable);
+            }
+            trailing_variable = chunk.trailing_variable;
+        }
+        for (const auto &token : chunk.tokens) {
+            switch (token.type) {
+                using enum TokenType;
+                case begin_t:
+                    if (!statement_starts.empty()) {
+                        return {};
+                    }
+                    statement_starts.push_back(token.value.data() + token.value.size());
+                    ++depth;
+                    break;
+                case ifn_t:
+                case ifp_t:
+                case ifz_t:
+                case loop_t:
+                    if (depth == 1) {
+                        statement_starts.push_back(token.value.data());
+                    }
+                    ++depth;
+                    break;
+                case end_t:
+                    if (--depth == 0) {
+                        statement_starts.push_back(token.value.data());
+                        return statement_starts;
+                    }
+                    break;
+                default:
+                    if (depth == 1) {
+                        statement_starts.push_back(token.value.data());
+                    }
+            }
+        }
+    }
+    return {};
+}
+
+std::vector<const char *> ParallelParser::split_into_chunks() const {
+    // Chunks must not split tokens or comments. They thus end at white space or at the start or end of a comment.
+    std::vector<const char *> boundaries{characters_begin};
+    const auto *comments_known_until = characters_begin;
+    const auto chunk_size = (characters_end - characters_begin) / thread_count;
+    for (unsigned int chunk = 1; chunk < thread_count; ++chunk) {
+        auto *boundary = std::max(characters_begin + chunk * chunk_size, boundaries.back());
+        auto inside_comment = false;
+        while (comments_known_until < boundary) {
+            const auto *comment_start = std::find(comments_known_until, boundary, '{');
+            if (comment_start == boundary) {
+                comments_known_until = boundary;
+                break;
+            }
+            comments_known_until = std::find(comment_start, characters_end, '}');
+            if (comments_known_until != characters_end) {
+                ++comments_known_until;
+            }
+            inside_comment = comments_known_until > boundary;
+        }
+        if (inside_comment) {
+            boundary = comments_known_until;
+        } else {
+            boundary = std::find_if(boundary, characters_end, [](const char c) {
+                return classify(c) == CharacterClass::space || c == '{';
+            });
+        }
+        boundaries.push_back(boundary);
+    }
+    boundaries.push_back(characters_end);
+    return boundaries;
+}
+
+ParallelParser::ScannedChunk ParallelParser::scan_chunk(const char *begin, const char *end) {
+    ScannedChunk chunk;
+    std::optional<Token> previous_token;
+    try {
+        for (Lexer<const char *> lexer{begin, end}; lexer != decltype(lexer)(); ++lexer) {
+            auto token = *lexer;
+            switch (token.type) {
+                using enum TokenType;
+                case begin_t:
+                case ifn_t:
+                case ifp_t:
+                case ifz_t:
+                case loop_t:
+                case end_t:
+                case print_t:
+                case read_t:
+                case break_t:
+                    chunk.tokens.push_back(token);
+                    break;
+                case assignment_t:
+                    if (!previous_token) {
+                        chunk.starts_with_assignment = true;
+                    } else if (previous_token->type == variable_t) {
+                        chunk.tokens.push_back(*previous_token);
+                    }
+                    break;
+                default:
+                    break;
+            }
+            if (!previous_token) {
+                chunk.first_token_type = token.type;
+            }
+            previous_token = token;
+        }
+    } catch (const std::exception &) {
+        chunk.valid = false;
+    }
+    if (previous_token && previous_token->type == TokenType::variable_t) {
+        chunk.trailing_variable = previous_token->value.data();
+    }
+    return chunk;
+}
+
+std::vector<ParallelParser::Range>
+ParallelParser::split(const std::vector<const char *> &statement_starts) const {
+    // More ranges than threads balance statements of different sizes.
+    auto *first_character = statement_starts.front();
+    auto *last_character = statement_starts.back();
+    auto range_size = std::max<std::ptrdiff_t>((last_character - first_character) / (thread_count * 4), 1);
+    std::vector<Range> ranges;
+    auto *range_begin = first_character;
+    for (auto *statement_start : llvm::ArrayRef(statement_starts).drop_front()) {
+        if (statement_start - range_begin >= range_size || statement_start == last_character) {
+            ranges.push_back({range_begin, statement_start, &context.create_nested_context(), {}});
+            range_begin = statement_start;
+        }
+    }
+    return ranges;
+}
+
+void ParallelParser::parse_range(Range &range) {
+    // The range is enclosed in 'BEGIN' and 'END' and parsed as a program on its own. It is only valid if the parser
+    // stops at the enclosing 'END', i.e. after it has requested all tokens.
+    Lexer<const char *> lexer{range.begin, range.end, range.symbols};
+    auto begun = false;
+    auto ended = false;
+    auto range_source = [&]() -> std::optional<Token> {
+        if (!begun) {
+            begun = true;
+            return Token{TokenType::begin_t, "BEGIN"};
+        }
+        if (lexer != decltype(lexer)()) {
+            return lexer++;
+        }
+        if (!ended) {
+            ended = true;
+            return Token{TokenType::end_t, "END"};
+        }
+        return {};
+    };
+    try {
+        auto *program = Parser{TokenStream{range_source}, *range.context}.parse();
+        range.block = ended ? program->block : nullptr;
+    } catch (const std::exception &) {
+        range.block = nullptr;
+    }
+}
+
+void ParallelParser::relabel_symbols(Block *block, const std::vector<SymbolID> &new_symbols) {
+    llvm::SmallVector<Statement *, 64> pending_statements{block->statements.begin(), block->statements.end()};
+    llvm::SmallVector<Expression *, 64> pending_expressions;
+    while (!pending_statements.empty()) {
+        auto *statement = pending_statements.pop_back_val();
+        if (auto *nested_block = llvm::dyn_cast<Block>(statement)) {
+            pending_statements.append(nested_block->statements.begin(), nested_block->statements.end());
+        } else if (auto *if_statement = llvm::dyn_cast<IfStatement>(statement)) {
+            pending_expressions.push_back(if_statement->expression);
+            pending_statements.push_back(if_statement->then_block);
+            if (if_statement->else_block) {
+                pending_statements.push_back(if_statement->else_block);
+            }
+        } else if (auto *loop_statement = llvm::dyn_cast<LoopStatement>(statement)) {
+            pending_statements.push_back(loop_statement->block);
+        } else if (auto *print_statement = llvm::dyn_cast<PrintStatement>(statement)) {
+            pending_expressions.push_back(print_statement->expression);
+        } else if (auto *read_statement = llvm::dyn_cast<ReadStatement>(statement)) {
+            pending_expressions.push_back(read_statement->variable_expression);
+        } else if (auto *assignment_statement = llvm::dyn_cast<AssignmentStatement>(statement)) {
+            pending_expressions.push_back(assignment_statement->variable);
+            pending_expressions.push_back(assignment_statement->expression);
+        }
+        while (!pending_expressions.empty()) {
+            auto *expression = pending_expressions.pop_back_val();
+            if (auto *variable_expression = llvm::dyn_cast<VariableExpression>(expression)) {
+                variable_expression->symbol = new_symbols[variable_expression->symbol];
+            } else if (auto *binary_expression = llvm::dyn_cast<BinaryOperationExpression>(expression)) {
+                pending_expressions.push_back(binary_expression->left_expression);
+                pending_expressions.push_back(binary_expression->right_expression);
+            }
+        }
+    }
+}
+
+Program *ParallelParser::parse_sequentially() {
+    Lexer<const char *> lexer{characters_begin, characters_end, symbols};
+    return Parser{TokenStream{lexer, decltype(lexer)()}, context}.parse();
+}
@@ -1,152 +1,207 @@
 #include "parser/Parser.hpp"
 
-#include "llvm/ADT/StringSwitch.h"
+#include "llvm/ADT/SmallVector.h"
 
+#include <charconv>
 #include <stdexcept>
+#include <string>
+#include <vector>
 
-Parser::Parser(std::vector<Token> &tokens)
-  : token(tokens.begin()) {
-    if (token == tokens.end()) {
+Parser::Parser(TokenStream tokens, ASTContext &context)
+  : token(std::move(tokens))
+  , context(context) {
+    if (token.exhausted()) {
         throw std::logic_error("Got an invalid Bitsy program.");
     }
 }
 
-std::unique_ptr<Program> Parser::parse() {
+Program *Parser::parse() {
     if (token->type != TokenType::begin_t) {
         throw std::logic_error("Expecting token 'BEGIN'.");
     }
-    auto block = parse_block();
-    if (token->type != TokenType::end_t) {
-        throw std::logic_error("Expecting token 'END'.");
-    }
-    return std::make_unique<Program>(std::move(block));
-}
-
-std::unique_ptr<Block> Parser::parse_block(const TokenType additional_stop_token) {
-    std::vector<std::unique_ptr<Statement>> statements;
-    while ((++token)->type != TokenType::end_t && token->type != additional_stop_token) {
-        statements.push_back(parse_statement());
-    }
-    return std::make_unique<Block>(std::move(statements));
-}
+    using Owner = OpenBlock::Owner;
+    std::vector<OpenBlock> open_blocks{{Owner::program, 0}};
+    llvm::SmallVector<Statement *, 64> statements;
+    while (true) {
+        auto &open_block = open_blocks.back();
+        auto type = (++token)->type;
+        switch (type) {
+            using enum TokenType;
+            case end_t:
+                break;
+            case else_t:
+                if (open_block.owner == Owner::then_block) {
+                    break;
+                }
+                throw std::logic_error("Unknown token type.");
+            case ifn_t:
+            case ifp_t:
+            case ifz_t: {
+                auto if_statement_type = type == ifn_t   ? IfStatementType::negative
+                                         : type == ifp_t ? IfStatementType::positive
+                                                         : IfStatementType::zero;
+                auto *condition = parse_expression();
+                open_blocks.push_back({Owner::then_block, statements.size(), if_statement_type, condition});
+                continue;
+            }
+            case loop_t:
+                open_blocks.push_back({Owner::loop_statement, statements.size()});
+                continue;
+            default:
+                statements.push_back(parse_simple_statement());
+                continue;
+        }
 
-std::unique_ptr<Expression> Parser::parse_expression() {
-    if (auto left_expression = parse_single_expression_component()) {
-        return parse_binary_expression(0, std::move(left_expression));
-    }
-    return nullptr;
-}
+        auto block_statements = llvm::ArrayRef<Statement *>(statements).drop_front(open_block.first_statement);
+        auto *block = context.create<Block>(context.copy<Statement *>(block_statements));
+        statements.truncate(open_block.first_statement);
 
-std::unique_ptr<Expression> Parser::parse_single_expression_component() {
-    switch ((++token)->type) {
-        using enum TokenType;
-        case operator_t: {
-            auto symbol = token++->value;
-            if (symbol == "-" || symbol == "+") {
-                return std::make_unique<NumberExpression>(std::stol(symbol + token->value));
-            }
-            throw std::logic_error("Unknown unary operator '" + symbol + "'.");
+        Statement *statement = nullptr;
+        switch (open_block.owner) {
+            case Owner::program:
+                return context.create<Program>(block);
+            case Owner::loop_statement:
+                statement = context.create<LoopStatement>(block);
+                break;
+            case Owner::then_block:
+                if (type == TokenType::else_t) {
+                    open_block.owner = Owner::else_block;
+                    open_block.then_block = block;
+                    continue;
+                }
+                statement =
+                    context.create<IfStatement>(open_block.if_statement_type, open_block.condition, block, nullptr);
+                break;
+            case Owner::else_block:
+                statement = context.create<IfStatement>(open_block.if_statement_type,
+                                                        open_block.condition,
+                                                        open_block.then_block,
+                                                        block);
+                break;
         }
-        case number_t:
-            return std::make_unique<NumberExpression>(std::stol(token->value));
-        case variable_t:
-            return std::make_unique<VariableExpression>(token->value);
-        case left_parenthesis_t:
-            return parse_parenthesis_expression();
-        default:
-            throw std::logic_error("Unknown token type during expression parsing.");
+        open_blocks.pop_back();
+        statements.push_back(statement);
     }
 }
 
-std::unique_ptr<Expression> Parser::parse_parenthesis_expression() {
-    if (token->type != TokenType::left_parenthesis_t) {
-        throw std::logic_error("Expected opening parenthesis token.");
-    }
-    if (auto inner_expression = parse_expression()) {
-        if ((++token)->type != TokenType::right_parenthesis_t) {
-            throw std::logic_error("Expected closing parenthesis token.");
-        }
-        return inner_expression;
+static std::int32_t parse_number(const Token &number_token, const bool negate = false) {
+    const auto *number_end = number_token.value.data() + number_token.value.size();
+    long value;
+    auto [parse_end, error] = std::from_chars(number_token.value.data(), number_end, value);
+    if (error != std::errc() || parse_end != number_end) {
+        throw std::logic_error("Cannot parse '" + std::string(number_token.value) + "' as a number.");
     }
-    throw std::logic_error("Expression inside of parentheses cannot be parsed.");
+    return static_cast<std::int32_t>(negate ? -value : value);
 }
 
-static int get_operator_precedence(const std::string &operator_token) {
-    // clang-format off
-    return llvm::StringSwitch<int>(operator_token)
-               .Cases("+", "-", 100)
-               .Cases("*", "/", "%", 200)
-               .Default(-1);
-    // clang-format on
+static int get_operator_precedence(const char operator_symbol) {
+    switch (operator_symbol) {
+        case '+':
+        case '-':
+            return 100;
+        case '*':
+        case '/':
+        case '%':
+            return 200;
+        default:
+            return -1;
+    }
 }
 
-std::unique_ptr<Expression> Parser::parse_binary_expression(int precedence,
-                                                            std::unique_ptr<Expression> left_expression) {
+Expression *Parser::parse_expression() {
+    // Operator precedence parsing on explicit stacks. An opening parenthesis on the operator stack delimits a nested
+    // expression, which thus does not need a nested call.
+    llvm::SmallVector<Expression *, 16> operands;
+    llvm::SmallVector<char, 16> operators;
+    std::size_t open_parentheses = 0;
+    auto reduce = [&]() {
+        auto *right_expression = operands.pop_back_val();
+        auto *left_expression = operands.pop_back_val();
+        operands.push_back(
+            context.create<BinaryOperationExpression>(operators.pop_back_val(), left_expression, right_expression));
+    };
     while (true) {
-        if ((token + 1)->type != TokenType::operator_t) {
-            return left_expression;
+        if ((++token)->type == TokenType::left_parenthesis_t) {
+            operators.push_back('(');
+            ++open_parentheses;
+            continue;
+        }
+        operands.push_back(parse_operand());
+        while (token.peek().type != TokenType::operator_t) {
+            if (open_parentheses == 0) {
+                while (!operators.empty()) {
+                    reduce();
+                }
+                return operands.back();
+            }
+            if ((++token)->type != TokenType::right_parenthesis_t) {
+                throw std::logic_error("Expected closing parenthesis token.");
+            }
+            while (operators.back() != '(') {
+                reduce();
+            }
+            operators.pop_back();
+            --open_parentheses;
         }
-        auto operator_token = (token + 1)->value;
-        int operator_precedence = get_operator_precedence(operator_token);
-        if (operator_precedence < precedence) {
-            return left_expression;
+        // The lexer groups runs of operator characters, but binary operators are single characters.
+        if ((++token)->value.size() != 1) {
+            throw std::logic_error("Unknown binary operator '" + std::string(token->value) + "'.");
         }
-        ++token;
-        auto right_expression = parse_single_expression_component();
-        if (!right_expression) {
-            throw std::logic_error("Unable to parse right hand side expression.");
+        auto operator_symbol = token->value[0];
+        auto precedence = get_operator_precedence(operator_symbol);
+        while (!operators.empty() && operators.back() != '(' && get_operator_precedence(operators.back()) >= precedence) {
+            reduce();
         }
-        int next_operator_precedence = get_operator_precedence((token + 1)->value);
-        if (operator_precedence < next_operator_precedence) {
-            right_expression = parse_binary_expression(operator_precedence + 1, std::move(right_expression));
-            if (!right_expression) {
-                return nullptr;
+        operators.push_back(operator_symbol);
+    }
+}
+
+Expression *Parser::parse_operand() {
+    switch (token->type) {
+        using enum TokenType;
+        case operator_t: {
+            auto symbol = token->value;
+            ++token;
+            if (symbol == "-") {
+                return context.create<NumberExpression>(parse_number(*token, true));
+            }
+            if (symbol == "+") {
+                return context.create<NumberExpression>(parse_number(*token));
             }
+            throw std::logic_error("Unknown unary operator '" + std::string(symbol) + "'.");
         }
-        left_expression = std::make_unique<BinaryOperationExpression>(operator_token[0],
-                                                                      std::move(left_expression),
-                                                                      std::move(right_expression));
+        case number_t:
+            return context.create<NumberExpression>(parse_number(*token));
+        case variable_t:
+            return context.create<VariableExpression>(token->symbol);
+        default:
+            throw std::logic_error("Unknown token type during expression parsing.");
     }
 }
 
-std::unique_ptr<Statement> Parser::parse_statement() {
+Statement *Parser::parse_simple_statement() {
     switch (token->type) {
         using enum TokenType;
-        case ifn_t:
-            return parse_if_statement(IfStatementType::negative);
-        case ifp_t:
-            return parse_if_statement(IfStatementType::positive);
-        case ifz_t:
-            return parse_if_statement(IfStatementType::zero);
-        case loop_t:
-            return std::make_unique<LoopStatement>(parse_block());
         case print_t:
-            return std::make_unique<PrintStatement>(parse_expression());
+            return context.create<PrintStatement>(parse_expression());
         case read_t: {
             if ((++token)->type != variable_t) {
                 throw std::logic_error("Expecting a variable as the argument of a 'READ' statement.");
             }
-            auto variable_expression = std::make_unique<VariableExpression>(token->value);
-            return std::make_unique<ReadStatement>(std::move(variable_expression));
+            auto *variable_expression = context.create<VariableExpression>(token->symbol);
+            return context.create<ReadStatement>(variable_expression);
         }
         case break_t:
-            return std::make_unique<BreakStatement>();
+            return context.create<BreakStatement>();
         case variable_t: {
-            auto assignee = std::make_unique<VariableExpression>(token->value);
+            auto *assignee = context.create<VariableExpression>(token->symbol);
             if ((++token)->type != assignment_t) {
                 throw std::logic_error("Expecting an assignment operator '='.");
             }
-            auto assignment = parse_expression();
-            return std::make_unique<AssignmentStatement>(std::move(assignee), std::move(assignment));
+            auto *assignment = parse_expression();
+            return context.create<AssignmentStatement>(assignee, assignment);
         }
         default:
             throw std::logic_error("Unknown token type.");
     }
 }
-
-std::unique_ptr<Statement> Parser::parse_if_statement(const IfStatementType type) {
-    auto expression = parse_expression();
-    auto then_block = parse_block(TokenType::else_t);
-    auto else_block = token->type == TokenType::else_t ? parse_block() : nullptr;
-    return std::make_unique<IfStatement>(type, std::move(expression), std::move(then_block), std::move(else_block));
-}
@@ -0,0 +1,27 @@
+#include "parser/TokenStream.hpp"
+
+#include <cassert>
+#include <stdexcept>
+
+const Token &TokenStream::peek(const std::size_t offset) {
+    if (!fetch(offset)) {
+        throw std::logic_error("Unexpected end of the Bitsy program.");
+    }
+    return *buffer[(position + offset) % lookahead];
+}
+
+bool TokenStream::exhausted() {
+    return !fetch(0);
+}
+
+bool TokenStream::fetch(const std::size_t offset) {
+    assert(offset < lookahead && "Peeking further than the lookahead buffer reaches.");
+    while (fetched <= position + offset) {
+        auto token = source();
+        if (!token) {
+            return false;
+        }
+        buffer[fetched++ % lookahead] = token;
+    }
+    return true;
+}
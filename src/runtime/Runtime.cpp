@@ -0,0 +1,240 @@
+#include "runtime/Runtime.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include <unistd.h>
+
+// The runtime ends up in executables linked by a C compiler driver, so it must not depend on the C++ standard library
+// beyond the C functions it includes.
+
+namespace {
+
+// Large enough that print-heavy programs write rarely, small enough to live in the thread-local storage.
+constexpr std::size_t buffer_size = 64 * 1024;
+// A sign, ten digits and a newline.
+constexpr std::size_t max_number_length = 12;
+
+struct OutputBuffer {
+    char data[buffer_size];
+    std::size_t size;
+};
+
+thread_local OutputBuffer output;
+
+struct InputBuffer {
+    const char *data;
+    std::size_t begin;
+    std::size_t end;
+};
+
+// The standard input is read ahead in large chunks. It is shared by all threads like the standard input itself.
+constexpr std::size_t input_buffer_size = 1024 * 1024;
+
+char standard_input_data[input_buffer_size];
+InputBuffer standard_input{standard_input_data, 0, 0};
+
+// A thread with I/O of its own reads the chunks of that I/O in place.
+thread_local const BitsyIO *io = nullptr;
+thread_local InputBuffer io_input;
+
+// 'strtol' saturates at the limits of 'long', which 'scanf("%i")' then truncates to an 'int'.
+constexpr std::uint64_t saturated_magnitude = std::uint64_t{1} << 63;
+
+constexpr char digit_pairs[] = "00010203040506070809"
+                               "10111213141516171819"
+                               "20212223242526272829"
+                               "30313233343536373839"
+                               "40414243444546474849"
+                               "50515253545556575859"
+                               "60616263646566676869"
+                               "70717273747576777879"
+                               "80818283848586878889"
+                               "90919293949596979899";
+
+void write_all(const char *data, std::size_t size) {
+    if (io) {
+        io->write(io->context, data, size);
+        return;
+    }
+    while (size > 0) {
+        auto written = write(STDOUT_FILENO, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+}
+
+bool refill_input(InputBuffer &input) {
+    input.begin = 0;
+    if (io) {
+        input.end = io->read(io->context, &input.data);
+        return input.end > 0;
+    }
+    for (;;) {
+        auto size = read(STDIN_FILENO, standard_input_data, input_buffer_size);
+        if (size < 0 && errno == EINTR) {
+            continue;
+        }
+        input.end = size > 0 ? static_cast<std::size_t>(size) : 0;
+        return size > 0;
+    }
+}
+
+// Returns the next character without consuming it, or 'EOF'.
+int peek_input(InputBuffer &input) {
+    if (input.begin == input.end && !refill_input(input)) {
+        return EOF;
+    }
+    return static_cast<unsigned char>(input.data[input.begin]);
+}
+
+bool is_space(const int character) {
+    return character == ' ' || (character >= '\t' && character <= '\r');
+}
+
+int get_digit(const int character, const unsigned int base) {
+    unsigned int digit = base;
+    if (character >= '0' && character <= '9') {
+        digit = static_cast<unsigned int>(character - '0');
+    } else if (character >= 'a' && character <= 'f') {
+        digit = static_cast<unsigned int>(character - 'a' + 10);
+    } else if (character >= 'A' && character <= 'F') {
+        digit = static_cast<unsigned int>(character - 'A' + 10);
+    }
+    return digit < base ? static_cast<int>(digit) : -1;
+}
+
+// Consumes eight decimal digits at once if they are next in the buffer, see
+// http://0x80.pl/articles/simd-parsing-int-sequences.html for the technique.
+bool consume_eight_digits(InputBuffer &input, std::uint64_t &magnitude) {
+    if constexpr (std::endian::native != std::endian::little) {
+        return false;
+    }
+    if (input.end - input.begin < 8) {
+        return false;
+    }
+    std::uint64_t chunk;
+    std::memcpy(&chunk, input.data + input.begin, sizeof(chunk));
+    // Every byte has to be in '0' to '9', i.e. its high nibble is 3 and adding 6 does not carry into it.
+    if (((chunk & 0xF0F0F0F0F0F0F0F0) | (((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) !=
+        0x3333333333333333) {
+        return false;
+    }
+    chunk -= 0x3030303030303030;
+    chunk = chunk * 10 + (chunk >> 8);
+    chunk = ((chunk & 0x000000FF000000FF) * (100 + (1000000ULL << 32)) +
+             ((chunk >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32))) >>
+            32;
+    magnitude = magnitude > (saturated_magnitude - chunk) / 100000000 ? saturated_magnitude
+                                                                       : magnitude * 100000000 + chunk;
+    input.begin += 8;
+    return true;
+}
+
+} // namespace
+
+void bitsy_print_i32(const std::int32_t value) {
+    if (buffer_size - output.size < max_number_length) {
+        bitsy_flush();
+    }
+    // Digits are produced back to front, two at a time.
+    char digits[max_number_length];
+    auto *begin = digits + max_number_length;
+    *--begin = '\n';
+    auto magnitude = value < 0 ? 0U - static_cast<std::uint32_t>(value) : static_cast<std::uint32_t>(value);
+    while (magnitude >= 100) {
+        auto pair = magnitude % 100 * 2;
+        magnitude /= 100;
+        *--begin = digit_pairs[pair + 1];
+        *--begin = digit_pairs[pair];
+    }
+    if (magnitude >= 10) {
+        *--begin = digit_pairs[magnitude * 2 + 1];
+        *--begin = digit_pairs[magnitude * 2];
+    } else {
+        *--begin = static_cast<char>('0' + magnitude);
+    }
+    if (value < 0) {
+        *--begin = '-';
+    }
+    auto length = static_cast<std::size_t>(digits + max_number_length - begin);
+    std::memcpy(output.data + output.size, begin, length);
+    output.size += length;
+}
+
+void bitsy_flush() {
+    write_all(output.data, output.size);
+    output.size = 0;
+}
+
+std::int32_t bitsy_read_i32(const std::int32_t current) {
+    bitsy_flush();
+    auto &input = io ? io_input : standard_input;
+    auto character = peek_input(input);
+    while (is_space(character)) {
+        ++input.begin;
+        character = peek_input(input);
+    }
+    bool negative = false;
+    if (character == '+' || character == '-') {
+        negative = character == '-';
+        ++input.begin;
+        character = peek_input(input);
+    }
+    // Like 'scanf("%i")', a leading '0x' starts a hexadecimal and a leading '0' an octal number.
+    unsigned int base = 10;
+    bool has_digits = false;
+    if (character == '0') {
+        has_digits = true;
+        base = 8;
+        ++input.begin;
+        character = peek_input(input);
+        if (character == 'x' || character == 'X') {
+            base = 16;
+            ++input.begin;
+            character = peek_input(input);
+        }
+    }
+    std::uint64_t magnitude = 0;
+    if (base == 10 && consume_eight_digits(input, magnitude)) {
+        has_digits = true;
+        character = peek_input(input);
+    }
+    const auto magnitude_limit = saturated_magnitude / base;
+    for (int digit; (digit = get_digit(character, base)) >= 0; character = peek_input(input)) {
+        has_digits = true;
+        magnitude = magnitude > magnitude_limit
+                        ? saturated_magnitude
+                        : std::min(magnitude * base + static_cast<unsigned int>(digit), saturated_magnitude);
+        ++input.begin;
+    }
+    if (!has_digits) {
+        return current;
+    }
+    if (!negative && magnitude == saturated_magnitude) {
+        --magnitude;
+    }
+    if (negative) {
+        magnitude = 0 - magnitude;
+    }
+    return static_cast<std::int32_t>(static_cast<std::uint32_t>(magnitude));
+}
+
+const BitsyIO *bitsy_set_io(const BitsyIO *new_io) {
+    bitsy_flush();
+    const auto *previous_io = io;
+    io = new_io;
+    io_input = {nullptr, 0, 0};
+    return previous_io;
+}
@@ -0,0 +1,205 @@
+#include "server/CompileServer.hpp"
+
+#include "server/Protocol.hpp"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <utility>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+// The socket file is removed when the server is terminated by a signal, which only allows for plain data.
+char socket_path_to_remove[sizeof(sockaddr_un::sun_path)];
+
+void remove_socket_and_exit(int signal) {
+    unlink(socket_path_to_remove);
+    _exit(128 + signal);
+}
+
+// Others must neither replace the socket nor connect to it, so its directory has to be the user's and must not be
+// writable by anyone else. A missing directory is created for the user only.
+bool prepare_directory(const std::string &directory, llvm::raw_ostream &diagnostics) {
+    if (mkdir(directory.c_str(), 0700) != 0 && errno != EEXIST) {
+        diagnostics << "Cannot create the directory " << directory << ": " << std::strerror(errno) << '\n';
+        return false;
+    }
+    struct stat status {};
+    if (lstat(directory.c_str(), &status) != 0 || !S_ISDIR(status.st_mode) || status.st_uid != getuid() ||
+        (status.st_mode & (S_IWGRP | S_IWOTH)) != 0) {
+        diagnostics << "The directory " << directory << " of the socket must belong to the user and must not be "
+                    << "writable by others." << '\n';
+        return false;
+    }
+    return true;
+}
+
+void set_signal_handler(const int signal, void (*handler)(int)) {
+    struct sigaction action {};
+    action.sa_handler = handler;
+    sigemptyset(&action.sa_mask);
+    sigaction(signal, &action, nullptr);
+}
+
+[[noreturn]] void run_request(const Request &request, const CompileServer::Handler &handler) {
+    for (int stream = 0; stream < 3; ++stream) {
+        dup2(request.standard_streams[stream], stream);
+        close(request.standard_streams[stream]);
+    }
+    if (chdir(request.working_directory.c_str()) != 0) {
+        std::cerr << "Cannot change to the working directory " << request.working_directory << "." << '\n';
+        std::_Exit(1);
+    }
+    // Returning runs the destructors of the static objects, which flush the remaining output.
+    std::exit(handler(request.arguments));
+}
+
+void handle_connection(const int connection, const CompileServer::Handler &handler) {
+    auto request = receive_request(connection);
+    if (!request) {
+        return;
+    }
+
+    // SIGCHLD stays blocked except for while waiting, so it cannot get lost in between.
+    sigset_t child_signal;
+    sigset_t waiting_mask;
+    sigemptyset(&child_signal);
+    sigaddset(&child_signal, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &child_signal, &waiting_mask);
+    sigdelset(&waiting_mask, SIGCHLD);
+    set_signal_handler(SIGCHLD, [](int) {});
+
+    auto program = fork();
+    if (program == 0) {
+        close(connection);
+        set_signal_handler(SIGCHLD, SIG_DFL);
+        sigprocmask(SIG_SETMASK, &waiting_mask, nullptr);
+        run_request(*request, handler);
+    }
+    for (auto stream : request->standard_streams) {
+        close(stream);
+    }
+    if (program < 0) {
+        send_status(connection, 1);
+        return;
+    }
+
+    // The client sends nothing after its request. Anything to read means that it has gone away, e.g. because the user
+    // interrupted it, so there is nobody left to care for the program.
+    int status = 0;
+    pollfd client{connection, POLLIN, 0};
+    while (waitpid(program, &status, WNOHANG) == 0) {
+        if (ppoll(&client, 1, nullptr, &waiting_mask) > 0) {
+            kill(program, SIGKILL);
+            waitpid(program, &status, 0);
+            return;
+        }
+    }
+    send_status(connection, WIFSIGNALED(status) ? 128 + WTERMSIG(status) : WEXITSTATUS(status));
+}
+
+} // namespace
+
+CompileServer::CompileServer(std::string socket_path)
+  : socket_path(std::move(socket_path)) {}
+
+CompileServer::~CompileServer() {
+    if (listening_socket >= 0) {
+        close(listening_socket);
+        unlink(socket_path.c_str());
+    }
+}
+
+bool CompileServer::listen(llvm::raw_ostream &diagnostics) {
+    sockaddr_un address{};
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        diagnostics << "The socket path " << socket_path << " is too long." << '\n';
+        return false;
+    }
+    auto directory = std::filesystem::path{socket_path}.parent_path();
+    if (!prepare_directory(directory.empty() ? "." : directory.string(), diagnostics)) {
+        return false;
+    }
+    // A socket left behind by a server that is gone can be replaced, but no other file.
+    struct stat status {};
+    if (lstat(socket_path.c_str(), &status) == 0) {
+        if (!S_ISSOCK(status.st_mode)) {
+            diagnostics << socket_path << " exists and is no socket." << '\n';
+            return false;
+        }
+        if (auto connection = connect_to_server(socket_path); connection >= 0) {
+            close(connection);
+            diagnostics << "Another server is listening on " << socket_path << " already." << '\n';
+            return false;
+        }
+        unlink(socket_path.c_str());
+    }
+
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+    listening_socket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    // Only the user may connect to the socket, whatever the umask of the server is.
+    auto previous_mask = umask(077);
+    auto bound = listening_socket >= 0 &&
+                 bind(listening_socket, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == 0;
+    umask(previous_mask);
+    if (!bound) {
+        diagnostics << "Cannot create the socket " << socket_path << ": " << std::strerror(errno) << '\n';
+        if (listening_socket >= 0) {
+            close(listening_socket);
+            listening_socket = -1;
+        }
+        return false;
+    }
+    if (::listen(listening_socket, SOMAXCONN) != 0) {
+        diagnostics << "Cannot listen on " << socket_path << ": " << std::strerror(errno) << '\n';
+        return false;
+    }
+    return true;
+}
+
+void CompileServer::serve(const Handler &handler) const {
+    std::memcpy(socket_path_to_remove, socket_path.c_str(), socket_path.size() + 1);
+    set_signal_handler(SIGINT, remove_socket_and_exit);
+    set_signal_handler(SIGTERM, remove_socket_and_exit);
+    // Connections end on their own. Ignoring their exit reaps them.
+    set_signal_handler(SIGCHLD, SIG_IGN);
+    // Buffered output would be written again by every forked process.
+    std::cout.flush();
+    std::fflush(nullptr);
+    llvm::outs().flush();
+
+    while (true) {
+        auto connection = accept4(listening_socket, nullptr, nullptr, SOCK_CLOEXEC);
+        if (connection < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            llvm::errs() << "Cannot accept requests: " << std::strerror(errno) << '\n';
+            return;
+        }
+        if (!is_same_user(connection)) {
+            close(connection);
+            continue;
+        }
+        if (fork() == 0) {
+            close(listening_socket);
+            set_signal_handler(SIGINT, SIG_DFL);
+            set_signal_handler(SIGTERM, SIG_DFL);
+            handle_connection(connection, handler);
+            std::_Exit(0);
+        }
+        close(connection);
+    }
+}
@@ -0,0 +1,209 @@
+#include "server/Protocol.hpp"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+bool send_all(const int socket, const void *data, std::size_t size) {
+    const auto *bytes = static_cast<const char *>(data);
+    while (size > 0) {
+        // A client that is gone must not kill the server with SIGPIPE.
+        auto sent = send(socket, bytes, size, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            return false;
+        }
+        bytes += sent;
+        size -= static_cast<std::size_t>(sent);
+    }
+    return true;
+}
+
+bool receive_all(const int socket, void *data, std::size_t size) {
+    auto *bytes = static_cast<char *>(data);
+    while (size > 0) {
+        auto received = recv(socket, bytes, size, 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            return false;
+        }
+        bytes += received;
+        size -= static_cast<std::size_t>(received);
+    }
+    return true;
+}
+
+void append_string(std::string &payload, const std::string &string) {
+    auto size = static_cast<std::uint32_t>(string.size());
+    payload.append(reinterpret_cast<const char *>(&size), sizeof(size));
+    payload.append(string);
+}
+
+std::optional<std::string> extract_string(const std::string &payload, std::size_t &offset) {
+    std::uint32_t size;
+    if (payload.size() - offset < sizeof(size)) {
+        return std::nullopt;
+    }
+    std::memcpy(&size, payload.data() + offset, sizeof(size));
+    offset += sizeof(size);
+    if (payload.size() - offset < size) {
+        return std::nullopt;
+    }
+    offset += size;
+    return payload.substr(offset - size, size);
+}
+
+} // namespace
+
+std::string get_default_socket_path() {
+    if (const auto *path = std::getenv("BITSYC_SOCKET")) {
+        return path;
+    }
+    if (const auto *directory = std::getenv("XDG_RUNTIME_DIR"); directory && *directory) {
+        return std::string{directory} + "/bitsyc.sock";
+    }
+    return "/tmp/bitsyc-" + std::to_string(getuid()) + "/bitsyc.sock";
+}
+
+bool is_same_user(const int socket) {
+    ucred credentials{};
+    socklen_t size = sizeof(credentials);
+    return getsockopt(socket, SOL_SOCKET, SO_PEERCRED, &credentials, &size) == 0 && credentials.uid == getuid();
+}
+
+int connect_to_server(const std::string &socket_path) {
+    sockaddr_un address{};
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        return -1;
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+    auto connection = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (connection < 0) {
+        return -1;
+    }
+    if (connect(connection, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 ||
+        !is_same_user(connection)) {
+        close(connection);
+        return -1;
+    }
+    return connection;
+}
+
+bool send_request(const int socket, const Request &request) {
+    std::string payload;
+    auto count = static_cast<std::uint32_t>(request.arguments.size());
+    payload.append(reinterpret_cast<const char *>(&count), sizeof(count));
+    append_string(payload, request.working_directory);
+    for (const auto &argument : request.arguments) {
+        append_string(payload, argument);
+    }
+
+    // The size of the payload comes first and carries the file descriptors.
+    auto size = static_cast<std::uint32_t>(payload.size());
+    iovec size_vector{&size, sizeof(size)};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(request.standard_streams))]{};
+    msghdr message{};
+    message.msg_iov = &size_vector;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    auto *header = CMSG_FIRSTHDR(&message);
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type = SCM_RIGHTS;
+    header->cmsg_len = CMSG_LEN(sizeof(request.standard_streams));
+    std::memcpy(CMSG_DATA(header), request.standard_streams.data(), sizeof(request.standard_streams));
+    ssize_t sent;
+    do {
+        sent = sendmsg(socket, &message, MSG_NOSIGNAL);
+    } while (sent < 0 && errno == EINTR);
+    if (sent != sizeof(size)) {
+        return false;
+    }
+    return send_all(socket, payload.data(), payload.size());
+}
+
+std::optional<Request> receive_request(const int socket) {
+    std::uint32_t size;
+    iovec size_vector{&size, sizeof(size)};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(Request::standard_streams))]{};
+    msghdr message{};
+    message.msg_iov = &size_vector;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    ssize_t received;
+    do {
+        received = recvmsg(socket, &message, MSG_CMSG_CLOEXEC);
+    } while (received < 0 && errno == EINTR);
+    if (received != sizeof(size)) {
+        return std::nullopt;
+    }
+
+    Request request;
+    auto *header = CMSG_FIRSTHDR(&message);
+    if (header && header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS &&
+        header->cmsg_len == CMSG_LEN(sizeof(request.standard_streams))) {
+        std::memcpy(request.standard_streams.data(), CMSG_DATA(header), sizeof(request.standard_streams));
+    }
+    auto close_streams = [&request]() {
+        for (auto stream : request.standard_streams) {
+            if (stream >= 0) {
+                close(stream);
+            }
+        }
+    };
+    if ((message.msg_flags & MSG_CTRUNC) != 0 || request.standard_streams[0] < 0) {
+        close_streams();
+        return std::nullopt;
+    }
+
+    std::string payload(size, '\0');
+    std::uint32_t count;
+    if (!receive_all(socket, payload.data(), payload.size()) || payload.size() < sizeof(count)) {
+        close_streams();
+        return std::nullopt;
+    }
+    std::memcpy(&count, payload.data(), sizeof(count));
+    std::size_t offset = sizeof(count);
+    auto working_directory = extract_string(payload, offset);
+    if (!working_directory) {
+        close_streams();
+        return std::nullopt;
+    }
+    request.working_directory = std::move(*working_directory);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        auto argument = extract_string(payload, offset);
+        if (!argument) {
+            close_streams();
+            return std::nullopt;
+        }
+        request.arguments.push_back(std::move(*argument));
+    }
+    return request;
+}
+
+bool send_status(const int socket, const int status) {
+    auto value = static_cast<std::int32_t>(status);
+    return send_all(socket, &value, sizeof(value));
+}
+
+std::optional<int> receive_status(const int socket) {
+    std::int32_t status;
+    if (!receive_all(socket, &status, sizeof(status))) {
+        return std::nullopt;
+    }
+    return status;
+}
@@ -2,34 +2,57 @@
 
 from os import listdir
 from os.path import dirname, join, realpath, splitext
-from re import findall
+from re import findall, search
 from subprocess import run
+from tempfile import TemporaryDirectory
 
 
 PROJECT_ROOT = join(dirname(realpath(__file__)), '..')
 BITSYC_PATH = join(PROJECT_ROOT, 'build', 'bitsyc')
-SPEC_PATH = join(PROJECT_ROOT, '..', 'bitsyspec', 'specs')
+SPEC_PATHS = [join(PROJECT_ROOT, '..', 'bitsyspec', 'specs'), join(PROJECT_ROOT, 'test', 'specs')]
 
 
 class TestCase:
 
-    def __init__(self, spec):
+    def __init__(self, spec_path, spec, options=()):
+        self.spec_path = spec_path
         self.spec = spec
+        self.options = list(options)
 
     @property
     def __spec_basename(self):
-        return splitext(self.spec)[0]
+        return ' '.join([splitext(self.spec)[0], *self.options])
 
+    # Returns None for specs of programs that must be rejected, which are marked by '{ error }'.
     def __parse_results(self):
-        with open(join(SPEC_PATH, self.spec), 'r') as file:
+        with open(join(self.spec_path, self.spec), 'r') as file:
             content = file.read().replace('\n', ' ')
+            if search(r'\{\s*error\s*\}', content):
+                return None
             return findall(r'\{.*?((?:-?\d+\s+)+)\}', content)[0].split()
 
+    def __execute(self):
+        command = [BITSYC_PATH, *self.options, join(self.spec_path, self.spec)]
+        if '-c' not in self.options:
+            return run(command, capture_output=True)
+        # Compiled programs are run from a temporary executable instead of bitsyc.
+        with TemporaryDirectory() as directory:
+            executable = join(directory, 'program')
+            compilation = run([*command, '-q', '-o', executable], capture_output=True)
+            if compilation.returncode != 0:
+                return compilation
+            return run([executable], capture_output=True)
+
     def run(self):
-        command = [BITSYC_PATH, join(SPEC_PATH, self.spec)]
-        process = run(command, capture_output=True)
+        process = self.__execute()
         actual = process.stdout.decode('ascii').split()
         expected = self.__parse_results()
+        if expected is None:
+            if process.returncode != 0 and not actual:
+                print(f'✅ {self.__spec_basename}')
+                return True
+            print(f'❌ {self.__spec_basename} expected an error but got {actual} (exit code {process.returncode}).')
+            return False
         if actual == expected:
             print(f'✅ {self.__spec_basename}')
             return True
@@ -38,4 +61,7 @@ class TestCase:
 
 
 if __name__ == '__main__':
-    exit(not all([TestCase(spec).run() for spec in listdir(SPEC_PATH)]))
+    modes = [(), ('-O0',), ('-O3',), ('--interpret',), ('--tiered',), ('--concurrent-lexing',), ('--flat-ast',),
+             ('--parse-threads=4',), ('--no-opt',), ('-c',)]
+    exit(not all([TestCase(spec_path, spec, mode).run()
+                  for spec_path in SPEC_PATHS for spec in listdir(spec_path) for mode in modes]))
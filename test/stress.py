@@ -0,0 +1,61 @@
+#!/usr/bin/env python3
+
+from os.path import dirname, join, realpath
+from subprocess import run
+from tempfile import NamedTemporaryFile
+
+
+PROJECT_ROOT = join(dirname(realpath(__file__)), '..')
+BITSYC_PATH = join(PROJECT_ROOT, 'build', 'bitsyc')
+DEPTH = 1_000_000
+
+
+# Programs with deeply nested blocks are only compiled. Generating machine code for millions of basic blocks takes
+# too long.
+def nested_loops():
+    return 'LOOP\n' * DEPTH + 'PRINT 1\nBREAK\n' + 'END\nBREAK\n' * (DEPTH - 1) + 'END\n', None
+
+
+# Reading the variable in the innermost loop leaves a phi incomplete in every loop header until the loops are sealed.
+def nested_loops_reading_variable():
+    return 'x = 4\n' + 'LOOP\n' * DEPTH + 'PRINT x\nBREAK\n' + 'END\nBREAK\n' * (DEPTH - 1) + 'END\n', None
+
+
+def nested_conditions():
+    return 'IFZ 0\n' * DEPTH + 'PRINT 2\n' + 'ELSE\nPRINT 0\nEND\n' * DEPTH, None
+
+
+def nested_parentheses():
+    return 'PRINT ' + '(' * DEPTH + '3' + ')' * DEPTH + '\n', ['3']
+
+
+def nested_operations():
+    return 'PRINT ' + '1 - (' * DEPTH + '0' + ')' * DEPTH + '\n', ['0']
+
+
+class StressTest:
+
+    def __init__(self, generator):
+        self.generator = generator
+
+    def run(self):
+        statements, expected = self.generator()
+        with NamedTemporaryFile('w', suffix='.bitsy') as file:
+            file.write('BEGIN\n' + statements + 'END\n')
+            file.flush()
+            for options in [[], ['--flat-ast']]:
+                if expected is None:
+                    options.append('-q')
+                process = run([BITSYC_PATH, '--no-opt', *options, file.name], capture_output=True)
+                actual = process.stdout.decode('ascii').split()
+                if process.returncode != 0 or actual != (expected or []):
+                    print(f'❌ {self.generator.__name__} {" ".join(options)} expected {expected} but got {actual} '
+                          f'(exit code {process.returncode}).')
+                    return False
+        print(f'✅ {self.generator.__name__}')
+        return True
+
+
+if __name__ == '__main__':
+    generators = [nested_loops, nested_loops_reading_variable, nested_conditions, nested_parentheses, nested_operations]
+    exit(not all([StressTest(generator).run() for generator in generators]))